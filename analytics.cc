@@ -0,0 +1,422 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <ready_trader_go/logging.h>
+
+#include "analytics.h"
+#include "backgroundthread.h"
+
+using namespace ReadyTraderGo;
+
+RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_AN, "ANLY")
+
+constexpr std::chrono::microseconds ANALYTICS_IDLE_SLEEP{100};
+
+Analytics::Analytics(const WarmState& warmState)
+{
+    // Only the sketches are merged: the mids held alongside them are stale.
+    auto history = std::make_unique<MarketStats>();
+    if (warmState.Get(WarmStateTag::MARKET_STATS, *history))
+    {
+        mAllMarketStats.Merge(*history);
+        mHasHistory = true;
+    }
+    mThread = std::thread(&Analytics::Run, this);
+}
+
+Analytics::~Analytics()
+{
+    Stop();
+}
+
+void Analytics::Stop()
+{
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+void Analytics::SaveWarmState(WarmState& warmState) const
+{
+    warmState.Put(WarmStateTag::MARKET_STATS, mAllMarketStats);
+}
+
+std::chrono::nanoseconds Analytics::Now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void Analytics::Push(const AnalyticsEvent& event) noexcept
+{
+    if (!mRing.TryPush(event))
+    {
+        mDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Analytics::QuoteEvaluated(bool skipped) noexcept
+{
+    // Only the io_context thread writes these, so a plain load and store
+    // will do where a locked increment would cost more than the evaluation
+    // being skipped.
+    mQuoteEvaluations.store(mQuoteEvaluations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (skipped)
+    {
+        mQuoteSkips.store(mQuoteSkips.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void Analytics::QuoteDeferred() noexcept
+{
+    mQuoteDeferrals.store(mQuoteDeferrals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void Analytics::OrderBook(Instrument instrument,
+                          unsigned long sequenceNumber,
+                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+{
+    AnalyticsEvent event;
+    event.type = AnalyticsEventType::ORDER_BOOK;
+    event.instrument = instrument;
+    event.timestamp = Now();
+    event.sequenceNumber = sequenceNumber;
+    event.askPrices = askPrices;
+    event.askVolumes = askVolumes;
+    event.bidPrices = bidPrices;
+    event.bidVolumes = bidVolumes;
+    Push(event);
+}
+
+void Analytics::TradeTicks(Instrument instrument,
+                           unsigned long sequenceNumber,
+                           const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                           const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+{
+    AnalyticsEvent event;
+    event.type = AnalyticsEventType::TRADE_TICKS;
+    event.instrument = instrument;
+    event.timestamp = Now();
+    event.sequenceNumber = sequenceNumber;
+    event.askPrices = askPrices;
+    event.askVolumes = askVolumes;
+    event.bidPrices = bidPrices;
+    event.bidVolumes = bidVolumes;
+    Push(event);
+}
+
+void Analytics::OrderFilled(unsigned long clientOrderId,
+                            Side side,
+                            unsigned long price,
+                            unsigned long volume,
+                            unsigned long hedgeId)
+{
+    AnalyticsEvent event;
+    event.type = AnalyticsEventType::ORDER_FILLED;
+    event.instrument = Instrument::ETF;
+    event.side = side;
+    event.timestamp = Now();
+    event.clientOrderId = clientOrderId;
+    event.hedgeId = hedgeId;
+    event.price = price;
+    event.volume = volume;
+    Push(event);
+}
+
+void Analytics::HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    AnalyticsEvent event;
+    event.type = AnalyticsEventType::HEDGE_FILLED;
+    event.instrument = Instrument::FUTURE;
+    event.timestamp = Now();
+    event.clientOrderId = clientOrderId;
+    event.price = price;
+    event.volume = volume;
+    Push(event);
+}
+
+void Analytics::Run()
+{
+    LowerThreadPriority();
+
+    mNextReport = Now() + ANALYTICS_REPORT_INTERVAL;
+    AnalyticsEvent event;
+    for (;;)
+    {
+        bool processed = false;
+        while (mRing.TryPop(event))
+        {
+            Process(event);
+            processed = true;
+        }
+
+        if (processed)
+        {
+            Publish();
+        }
+
+        if (Now() >= mNextReport)
+        {
+            Report();
+            mNextReport += ANALYTICS_REPORT_INTERVAL;
+        }
+
+        if (!mRunning.load(std::memory_order_acquire) && mRing.Size() == 0)
+        {
+            break;
+        }
+
+        if (!processed)
+        {
+            std::this_thread::sleep_for(ANALYTICS_IDLE_SLEEP);
+        }
+    }
+}
+
+void Analytics::Process(const AnalyticsEvent& event)
+{
+    switch (event.type)
+    {
+    case AnalyticsEventType::ORDER_BOOK:
+        ProcessOrderBook(event);
+        break;
+    case AnalyticsEventType::TRADE_TICKS:
+        ProcessTradeTicks(event);
+        break;
+    case AnalyticsEventType::ORDER_FILLED:
+        ProcessOrderFilled(event);
+        break;
+    case AnalyticsEventType::HEDGE_FILLED:
+        ProcessHedgeFilled(event);
+        break;
+    }
+    mProcessedEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Analytics::ProcessOrderBook(const AnalyticsEvent& event)
+{
+    RLOG(LG_AN, LogLevel::LL_INFO) << "order book received for " << event.instrument << " instrument"
+                                   << ": ask prices: " << event.askPrices[0]
+                                   << "; ask volumes: " << event.askVolumes[0]
+                                   << "; bid prices: " << event.bidPrices[0]
+                                   << "; bid volumes: " << event.bidVolumes[0];
+
+    const std::size_t instrument = static_cast<std::size_t>(event.instrument);
+    const std::size_t count = mBookEventInference.Update(event.instrument, event.askPrices, event.askVolumes,
+                                                         event.bidPrices, event.bidVolumes, mBookEvents);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const BookEvent& bookEvent = mBookEvents[i];
+        if (bookEvent.type == BookEventType::SHIFT)
+        {
+            continue;
+        }
+        const auto volume = static_cast<signed long>(bookEvent.volume);
+        const bool added = bookEvent.type == BookEventType::ADD;
+        mBookEventVolumes[instrument][static_cast<std::size_t>(bookEvent.type)] += bookEvent.volume;
+        mOrderFlow[instrument] += ((bookEvent.side == Side::BUY) == added) ? volume : -volume;
+    }
+
+    mMarketStats.OrderBook(event.instrument, event.askPrices[0], event.bidPrices[0]);
+    mAllMarketStats.OrderBook(event.instrument, event.askPrices[0], event.bidPrices[0]);
+    if (event.askPrices[0] != 0 && event.bidPrices[0] != 0)
+    {
+        mMidPrices[static_cast<std::size_t>(event.instrument)] = (event.askPrices[0] + event.bidPrices[0]) / 2;
+    }
+
+    if (event.instrument != Instrument::ETF || mMidPrices[static_cast<std::size_t>(Instrument::ETF)] == 0)
+    {
+        return;
+    }
+
+    const signed long mid = static_cast<signed long>(mMidPrices[static_cast<std::size_t>(Instrument::ETF)]);
+    for (std::size_t h = 0; h < MARKOUT_HORIZON_COUNT; ++h)
+    {
+        auto& pending = mPendingMarkouts[h];
+        while (!pending.empty() && event.timestamp - pending.front().timestamp >= MARKOUT_HORIZONS[h])
+        {
+            const PendingMarkout& markout = pending.front();
+            mMarkoutTotals[h] += (mid - static_cast<signed long>(markout.price)) * markout.signedVolume;
+            mMarkoutVolumes[h] += static_cast<unsigned long>(std::labs(markout.signedVolume));
+            pending.pop_front();
+        }
+    }
+}
+
+void Analytics::ProcessTradeTicks(const AnalyticsEvent& event)
+{
+    RLOG(LG_AN, LogLevel::LL_INFO) << "trade ticks received for " << event.instrument << " instrument"
+                                   << ": ask prices: " << event.askPrices[0]
+                                   << "; ask volumes: " << event.askVolumes[0]
+                                   << "; bid prices: " << event.bidPrices[0]
+                                   << "; bid volumes: " << event.bidVolumes[0];
+
+    VWAPWindow& window = mVWAPWindows[static_cast<std::size_t>(event.instrument)];
+    unsigned long notional = 0;
+    unsigned long volume = 0;
+    for (int i = 0; i < TOP_LEVEL_COUNT; ++i)
+    {
+        notional += event.askPrices[i] * event.askVolumes[i] + event.bidPrices[i] * event.bidVolumes[i];
+        volume += event.askVolumes[i] + event.bidVolumes[i];
+    }
+    if (volume != 0)
+    {
+        window.ticks.push_back({event.timestamp, {notional, volume}});
+        window.notional += notional;
+        window.volume += volume;
+    }
+
+    while (!window.ticks.empty() && event.timestamp - window.ticks.front().first > VWAP_WINDOW)
+    {
+        window.notional -= window.ticks.front().second.first;
+        window.volume -= window.ticks.front().second.second;
+        window.ticks.pop_front();
+    }
+}
+
+void Analytics::ProcessOrderFilled(const AnalyticsEvent& event)
+{
+    RLOG(LG_AN, LogLevel::LL_INFO) << "order " << event.clientOrderId << " filled for " << event.volume
+                                   << " lots at $" << event.price << " cents";
+
+    const signed long signedVolume = (event.side == Side::BUY) ? static_cast<signed long>(event.volume)
+                                                               : -static_cast<signed long>(event.volume);
+    mETFPositionLocal += signedVolume;
+    mCash -= signedVolume * static_cast<signed long>(event.price);
+    mMarketStats.Filled(event.side, event.price, event.volume);
+    mAllMarketStats.Filled(event.side, event.price, event.volume);
+
+    for (auto& pending : mPendingMarkouts)
+    {
+        pending.push_back({event.timestamp, signedVolume, event.price});
+    }
+
+    if (event.hedgeId != 0)
+    {
+        mHedgeSides.emplace(event.hedgeId, (event.side == Side::BUY) ? Side::SELL : Side::BUY);
+    }
+}
+
+void Analytics::ProcessHedgeFilled(const AnalyticsEvent& event)
+{
+    RLOG(LG_AN, LogLevel::LL_INFO) << "hedge order " << event.clientOrderId << " filled for " << event.volume
+                                   << " lots at $" << event.price << " average price in cents";
+
+    auto it = mHedgeSides.find(event.clientOrderId);
+    if (it == mHedgeSides.end())
+    {
+        return;
+    }
+
+    const signed long signedVolume = (it->second == Side::BUY) ? static_cast<signed long>(event.volume)
+                                                               : -static_cast<signed long>(event.volume);
+    mFuturePositionLocal += signedVolume;
+    mCash -= signedVolume * static_cast<signed long>(event.price);
+    mHedgeSides.erase(it);
+}
+
+void Analytics::Publish()
+{
+    const auto etfMid = static_cast<signed long>(mMidPrices[static_cast<std::size_t>(Instrument::ETF)]);
+    const auto futureMid = static_cast<signed long>(mMidPrices[static_cast<std::size_t>(Instrument::FUTURE)]);
+
+    mETFPosition.store(mETFPositionLocal, std::memory_order_relaxed);
+    mFuturePosition.store(mFuturePositionLocal, std::memory_order_relaxed);
+    mProfitLoss.store(mCash + mETFPositionLocal * etfMid + mFuturePositionLocal * futureMid,
+                      std::memory_order_relaxed);
+
+    for (std::size_t h = 0; h < MARKOUT_HORIZON_COUNT; ++h)
+    {
+        if (mMarkoutVolumes[h] != 0)
+        {
+            mMarkouts[h].store(mMarkoutTotals[h] / static_cast<signed long>(mMarkoutVolumes[h]),
+                               std::memory_order_relaxed);
+        }
+    }
+
+    for (std::size_t i = 0; i < mVWAPWindows.size(); ++i)
+    {
+        const VWAPWindow& window = mVWAPWindows[i];
+        mVWAPs[i].store(window.volume != 0 ? window.notional / window.volume : 0, std::memory_order_relaxed);
+    }
+}
+
+void Analytics::Report()
+{
+    for (std::size_t i = 0; i < mOrderFlow.size(); ++i)
+    {
+        mOrderFlowImbalances[i].store(mOrderFlow[i], std::memory_order_relaxed);
+    }
+
+    RLOG(LG_AN, LogLevel::LL_INFO) << "analytics: etf position " << mETFPositionLocal
+                                   << "; future position " << mFuturePositionLocal
+                                   << "; marked pnl " << ProfitLoss()
+                                   << " cents; markouts " << Markout(0) << "/" << Markout(1) << "/" << Markout(2)
+                                   << " cents per lot; vwap etf " << VWAP(Instrument::ETF)
+                                   << " future " << VWAP(Instrument::FUTURE)
+                                   << "; book flow etf " << FlowSummary(Instrument::ETF)
+                                   << " future " << FlowSummary(Instrument::FUTURE)
+                                   << "; quotes " << QuoteEvaluations()
+                                   << " evaluated " << QuoteSkips() << " skipped " << QuoteDeferrals() << " deferred"
+                                   << "; events " << ProcessedEvents()
+                                   << " processed " << DroppedEvents() << " dropped";
+    mBookEventVolumes = {};
+    mOrderFlow = {};
+
+    RLOG(LG_AN, LogLevel::LL_INFO) << "analytics session quantiles p50/p90/p99:" << Quantiles(mMarketStats);
+    if (mHasHistory)
+    {
+        RLOG(LG_AN, LogLevel::LL_INFO) << "analytics quantiles p50/p90/p99 including earlier sessions:"
+                                       << Quantiles(mAllMarketStats);
+    }
+}
+
+std::string Analytics::Quantiles(MarketStats& stats)
+{
+    std::ostringstream quantiles;
+    for (std::size_t i = 0; i < MARKET_STAT_COUNT; ++i)
+    {
+        const auto stat = static_cast<MarketStat>(i);
+        QuantileSketch& sketch = stats[stat];
+        quantiles << ' ' << MarketStatName(stat) << ' ' << sketch.Quantile(0.5) << '/' << sketch.Quantile(0.9)
+                  << '/' << sketch.Quantile(0.99);
+    }
+    return quantiles.str();
+}
+
+std::string Analytics::FlowSummary(Instrument instrument) const
+{
+    const auto& volumes = mBookEventVolumes[static_cast<std::size_t>(instrument)];
+    const signed long flow = mOrderFlow[static_cast<std::size_t>(instrument)];
+    return "added " + std::to_string(volumes[0]) + " cancelled " + std::to_string(volumes[1]) + " depleted "
+           + std::to_string(volumes[2]) + " net " + std::to_string(flow);
+}
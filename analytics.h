@@ -0,0 +1,227 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_ANALYTICS_H
+#define CPPREADY_TRADER_GO_ANALYTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <ready_trader_go/types.h>
+
+#include "bookevents.h"
+#include "marketstats.h"
+#include "spscring.h"
+#include "warmstate.h"
+
+constexpr std::size_t ANALYTICS_RING_CAPACITY = 4096;
+constexpr std::size_t MARKOUT_HORIZON_COUNT = 3;
+constexpr std::array<std::chrono::nanoseconds, MARKOUT_HORIZON_COUNT> MARKOUT_HORIZONS = {
+        std::chrono::milliseconds(100), std::chrono::seconds(1), std::chrono::seconds(10)};
+constexpr std::chrono::nanoseconds VWAP_WINDOW = std::chrono::seconds(5);
+constexpr std::chrono::nanoseconds ANALYTICS_REPORT_INTERVAL = std::chrono::seconds(1);
+
+enum class AnalyticsEventType : unsigned char
+{
+    ORDER_BOOK,
+    TRADE_TICKS,
+    ORDER_FILLED,
+    HEDGE_FILLED
+};
+
+// A raw market or execution event copied off the io_context thread. Order
+// books and trade ticks use the level arrays; fills use the scalar fields.
+struct AnalyticsEvent
+{
+    AnalyticsEventType type = AnalyticsEventType::ORDER_BOOK;
+    ReadyTraderGo::Instrument instrument = ReadyTraderGo::Instrument::ETF;
+    ReadyTraderGo::Side side = ReadyTraderGo::Side::BUY;
+    std::chrono::nanoseconds timestamp{0};
+    unsigned long sequenceNumber = 0;
+    unsigned long clientOrderId = 0;
+    unsigned long hedgeId = 0;
+    unsigned long price = 0;
+    unsigned long volume = 0;
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> askPrices{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> askVolumes{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> bidPrices{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> bidVolumes{};
+};
+
+// Non-critical statistics (markouts, marked PnL, trade VWAPs and periodic
+// reporting) maintained on a low-priority background thread.
+//
+// The io_context thread only copies events into a lock-free ring; the
+// analytics thread consumes them and publishes its results through atomics
+// which may be read from any thread. If the ring is full the event is
+// dropped and counted rather than blocking the caller.
+class Analytics
+{
+public:
+    // The market statistics learned in earlier sessions, if the warm state
+    // holds them, are restored before the analytics thread starts. They are
+    // kept apart from this session's, which the reports show on their own,
+    // and reported separately, labelled as including earlier sessions.
+    explicit Analytics(const WarmState& warmState);
+    ~Analytics();
+
+    Analytics(const Analytics&) = delete;
+    Analytics& operator=(const Analytics&) = delete;
+
+    // Producer side: must only be called from the io_context thread.
+    void OrderBook(ReadyTraderGo::Instrument instrument,
+                   unsigned long sequenceNumber,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
+    void TradeTicks(ReadyTraderGo::Instrument instrument,
+                    unsigned long sequenceNumber,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
+
+    // Record an ETF fill and the id of the hedge order sent in response, if
+    // any (zero otherwise). The hedge is assumed to be on the opposite side.
+    void OrderFilled(unsigned long clientOrderId,
+                     ReadyTraderGo::Side side,
+                     unsigned long price,
+                     unsigned long volume,
+                     unsigned long hedgeId);
+    void HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume);
+
+    // Count a quote evaluation by the order book handler, and whether its
+    // inputs were unchanged so that it was skipped.
+    void QuoteEvaluated(bool skipped) noexcept;
+
+    // Count a quote evaluation whose cancels or inserts were held back to
+    // save the message budget.
+    void QuoteDeferred() noexcept;
+
+    // Drain the ring and stop the analytics thread. Events pushed after this
+    // are dropped. Must only be called from the io_context thread.
+    void Stop();
+
+    // Store the state worth carrying into the next session. Only valid once
+    // the analytics thread has been stopped.
+    void SaveWarmState(WarmState& warmState) const;
+
+    // Published results: may be read from any thread.
+    signed long ETFPosition() const { return mETFPosition.load(std::memory_order_relaxed); }
+    signed long FuturePosition() const { return mFuturePosition.load(std::memory_order_relaxed); }
+
+    // Cash plus both positions marked at their latest mid prices, in cents.
+    signed long ProfitLoss() const { return mProfitLoss.load(std::memory_order_relaxed); }
+
+    // Average ETF mid move in our favour per lot filled, in cents, measured
+    // the given horizon after each fill.
+    signed long Markout(std::size_t horizon) const { return mMarkouts[horizon].load(std::memory_order_relaxed); }
+
+    // Volume weighted average traded price over the last VWAP_WINDOW, in
+    // cents, or zero if there was no trading in that window.
+    unsigned long VWAP(ReadyTraderGo::Instrument instrument) const
+    {
+        return mVWAPs[static_cast<std::size_t>(instrument)].load(std::memory_order_relaxed);
+    }
+
+    // Net order flow inferred from book changes over the last report
+    // interval, in lots: bid additions and ask removals count as buying
+    // pressure, ask additions and bid removals as selling pressure.
+    signed long OrderFlowImbalance(ReadyTraderGo::Instrument instrument) const
+    {
+        return mOrderFlowImbalances[static_cast<std::size_t>(instrument)].load(std::memory_order_relaxed);
+    }
+
+    unsigned long ProcessedEvents() const { return mProcessedEvents.load(std::memory_order_relaxed); }
+    unsigned long DroppedEvents() const { return mDroppedEvents.load(std::memory_order_relaxed); }
+    unsigned long QuoteEvaluations() const { return mQuoteEvaluations.load(std::memory_order_relaxed); }
+    unsigned long QuoteSkips() const { return mQuoteSkips.load(std::memory_order_relaxed); }
+    unsigned long QuoteDeferrals() const { return mQuoteDeferrals.load(std::memory_order_relaxed); }
+
+private:
+    struct PendingMarkout
+    {
+        std::chrono::nanoseconds timestamp;
+        signed long signedVolume;
+        unsigned long price;
+    };
+
+    struct VWAPWindow
+    {
+        std::deque<std::pair<std::chrono::nanoseconds, std::pair<unsigned long, unsigned long>>> ticks;
+        unsigned long notional = 0;
+        unsigned long volume = 0;
+    };
+
+    static std::chrono::nanoseconds Now() noexcept;
+
+    void Push(const AnalyticsEvent& event) noexcept;
+    void Run();
+    void Process(const AnalyticsEvent& event);
+    void ProcessOrderBook(const AnalyticsEvent& event);
+    void ProcessTradeTicks(const AnalyticsEvent& event);
+    void ProcessOrderFilled(const AnalyticsEvent& event);
+    void ProcessHedgeFilled(const AnalyticsEvent& event);
+    void Publish();
+    void Report();
+    std::string FlowSummary(ReadyTraderGo::Instrument instrument) const;
+    static std::string Quantiles(MarketStats& stats);
+
+    SPSCRing<AnalyticsEvent, ANALYTICS_RING_CAPACITY> mRing;
+    std::atomic<bool> mRunning{true};
+    std::atomic<unsigned long> mDroppedEvents{0};
+    std::atomic<unsigned long> mQuoteEvaluations{0};
+    std::atomic<unsigned long> mQuoteSkips{0};
+    std::atomic<unsigned long> mQuoteDeferrals{0};
+
+    // State below is owned by the analytics thread.
+    std::array<unsigned long, 2> mMidPrices{};
+    signed long mCash = 0;
+    signed long mETFPositionLocal = 0;
+    signed long mFuturePositionLocal = 0;
+    std::unordered_map<unsigned long, ReadyTraderGo::Side> mHedgeSides;
+    std::array<std::deque<PendingMarkout>, MARKOUT_HORIZON_COUNT> mPendingMarkouts;
+    std::array<signed long, MARKOUT_HORIZON_COUNT> mMarkoutTotals{};
+    std::array<unsigned long, MARKOUT_HORIZON_COUNT> mMarkoutVolumes{};
+    std::array<VWAPWindow, 2> mVWAPWindows;
+    BookEventInference mBookEventInference;
+    BookEvents mBookEvents;
+    std::array<std::array<unsigned long, 3>, 2> mBookEventVolumes{}; // by instrument, then ADD, CANCEL, DEPLETE
+    std::array<signed long, 2> mOrderFlow{};
+    MarketStats mMarketStats; // this session only, for the reports
+    MarketStats mAllMarketStats; // this and earlier sessions, carried in the warm state
+    bool mHasHistory = false;
+    std::chrono::nanoseconds mNextReport{0};
+
+    std::atomic<signed long> mETFPosition{0};
+    std::atomic<signed long> mFuturePosition{0};
+    std::atomic<signed long> mProfitLoss{0};
+    std::array<std::atomic<signed long>, MARKOUT_HORIZON_COUNT> mMarkouts{};
+    std::array<std::atomic<unsigned long>, 2> mVWAPs{};
+    std::array<std::atomic<signed long>, 2> mOrderFlowImbalances{};
+    std::atomic<unsigned long> mProcessedEvents{0};
+
+    std::thread mThread;
+};
+
+#endif //CPPREADY_TRADER_GO_ANALYTICS_H
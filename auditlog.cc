@@ -0,0 +1,170 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "auditlog.h"
+#include "backgroundthread.h"
+#include "sessionfile.h"
+
+constexpr std::size_t AUDIT_FILE_BUFFER_SIZE = 1 << 18;
+constexpr std::chrono::milliseconds AUDIT_IDLE_SLEEP{1};
+
+const char* AuditReasonName(AuditReason reason) noexcept
+{
+    switch (reason)
+    {
+    case AuditReason::INSERTED:
+        return "inserted";
+    case AuditReason::POSITION_LIMIT:
+        return "position-limit";
+    case AuditReason::EXPOSURE_LIMIT:
+        return "exposure-limit";
+    case AuditReason::ORDER_IN_FLIGHT:
+        return "order-in-flight";
+    case AuditReason::MESSAGE_BUDGET:
+        return "message-budget";
+    case AuditReason::NO_CROSS:
+        return "no-cross";
+    case AuditReason::UNCHANGED:
+        return "unchanged";
+    case AuditReason::SWEEP:
+        return "sweep";
+    }
+    return "unknown";
+}
+
+bool ReadAudit(const std::string& filename, std::vector<AuditRecord>& records, std::string& error)
+{
+    records.clear();
+
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    AuditHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != AUDIT_MAGIC)
+    {
+        std::fclose(file);
+        error = filename + " is not an audit file";
+        return false;
+    }
+    if (header.version != AUDIT_VERSION || header.recordSize != sizeof(AuditRecord))
+    {
+        std::fclose(file);
+        error = filename + " has audit version " + std::to_string(header.version) + ", expected "
+                + std::to_string(AUDIT_VERSION);
+        return false;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (!ec && size > sizeof(header))
+    {
+        records.resize((size - sizeof(header)) / sizeof(AuditRecord));
+    }
+    const std::size_t count = std::fread(records.data(), sizeof(AuditRecord), records.size(), file);
+    records.resize(count);
+    std::fclose(file);
+    return true;
+}
+
+std::vector<std::string> ListAudits(const std::string& directory)
+{
+    std::vector<std::string> result;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == AUDIT_EXTENSION)
+        {
+            result.push_back(entry.path().string());
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+AuditRecorder::AuditRecorder(std::FILE* file) : mFile(file), mThread(&AuditRecorder::Run, this)
+{
+}
+
+AuditRecorder::~AuditRecorder()
+{
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    std::fclose(mFile);
+}
+
+std::unique_ptr<AuditRecorder> AuditRecorder::Create(const std::string& directory,
+                                                     const std::string& session,
+                                                     std::string& error)
+{
+    std::string filename;
+    std::FILE* file = CreateSessionFile(directory, session, AUDIT_EXTENSION, filename, error);
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, AUDIT_FILE_BUFFER_SIZE);
+
+    AuditHeader header;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        std::fclose(file);
+        error = "cannot write to " + filename;
+        return nullptr;
+    }
+    return std::make_unique<AuditRecorder>(file);
+}
+
+void AuditRecorder::Run()
+{
+    LowerThreadPriority();
+    AuditRecord record;
+    for (;;)
+    {
+        bool written = false;
+        while (mRing.TryPop(record))
+        {
+            std::fwrite(&record, sizeof(record), 1, mFile);
+            written = true;
+        }
+
+        if (!mRunning.load(std::memory_order_acquire) && mRing.Size() == 0)
+        {
+            break;
+        }
+
+        if (written)
+        {
+            std::fflush(mFile);
+        }
+        else
+        {
+            std::this_thread::sleep_for(AUDIT_IDLE_SLEEP);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_AUDITLOG_H
+#define CPPREADY_TRADER_GO_AUDITLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+#include "spscring.h"
+
+constexpr unsigned int AUDIT_MAGIC = 0x41475452; // "RTGA"
+constexpr unsigned int AUDIT_VERSION = 1;
+constexpr std::size_t AUDIT_RING_CAPACITY = 16384;
+constexpr char AUDIT_EXTENSION[] = ".rtga";
+
+// What one evaluation did, as a set of flags.
+constexpr unsigned char AUDIT_SKIPPED = 1 << 0; // inputs unchanged, nothing evaluated
+constexpr unsigned char AUDIT_CANCEL_ASK = 1 << 1;
+constexpr unsigned char AUDIT_CANCEL_BID = 1 << 2;
+constexpr unsigned char AUDIT_INSERT_ASK = 1 << 3;
+constexpr unsigned char AUDIT_INSERT_BID = 1 << 4;
+constexpr unsigned char AUDIT_SWEEP = 1 << 5; // cancels pulled ahead of a sweep
+
+// Why a side ended an evaluation as it did. The ask side is our buy order
+// and the bid side our sell order, as in the AutoTrader.
+enum class AuditReason : unsigned char
+{
+    INSERTED,
+    POSITION_LIMIT,
+    EXPOSURE_LIMIT,
+    ORDER_IN_FLIGHT,
+    MESSAGE_BUDGET,
+    NO_CROSS,
+    UNCHANGED,
+    SWEEP
+};
+
+constexpr std::size_t AUDIT_REASON_COUNT = 8;
+
+const char* AuditReasonName(AuditReason reason) noexcept;
+
+// One fixed-width audit entry per evaluation: small enough that writing
+// one costs less than formatting a log line, and seekable like a journal.
+// The order ids are those live once the evaluation's cancels and inserts
+// were handed to the execution connection, which each send is as soon as
+// it is decided, so the record that inserted an order is the first to
+// carry its id.
+struct AuditRecord
+{
+    signed long timestamp = 0; // event time in nanoseconds
+    unsigned long inputsHash = 0; // QuoteKeyHash of the evaluation's inputs
+    unsigned long askId = 0;
+    unsigned long bidId = 0;
+    ReadyTraderGo::Instrument instrument = ReadyTraderGo::Instrument::ETF;
+    unsigned char action = 0;
+    AuditReason askReason = AuditReason::UNCHANGED;
+    AuditReason bidReason = AuditReason::UNCHANGED;
+    unsigned int reserved = 0;
+};
+
+static_assert(sizeof(AuditRecord) == 40, "audit records are fixed width");
+static_assert(std::is_trivially_copyable<AuditRecord>::value, "audit records are written as raw bytes");
+
+struct AuditHeader
+{
+    unsigned int magic = AUDIT_MAGIC;
+    unsigned int version = AUDIT_VERSION;
+    unsigned int recordSize = sizeof(AuditRecord);
+    unsigned int reserved = 0;
+};
+
+// Read a whole audit file into memory. Returns false and describes the
+// problem in error if the file is missing or malformed.
+bool ReadAudit(const std::string& filename, std::vector<AuditRecord>& records, std::string& error);
+
+// List the audit files in a directory, sorted by name.
+std::vector<std::string> ListAudits(const std::string& directory);
+
+// Records the AutoTrader's quote decisions to an audit file.
+//
+// Like the JournalRecorder, the io_context thread only copies records into
+// a lock-free ring and a low-priority background thread does the file I/O.
+// Records are dropped and counted if the ring is full.
+class AuditRecorder
+{
+public:
+    explicit AuditRecorder(std::FILE* file);
+    ~AuditRecorder();
+
+    AuditRecorder(const AuditRecorder&) = delete;
+    AuditRecorder& operator=(const AuditRecorder&) = delete;
+
+    // Create a recorder writing to a new audit file named for the session, see
+    // NewSessionName, in the given directory. Returns null if the directory
+    // does not exist or the file already does.
+    static std::unique_ptr<AuditRecorder> Create(const std::string& directory,
+                                                 const std::string& session,
+                                                 std::string& error);
+
+    // Producer side: must only be called from the io_context thread.
+    void Record(const AuditRecord& record) noexcept
+    {
+        if (!mRing.TryPush(record))
+        {
+            mDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    unsigned long DroppedRecords() const { return mDroppedRecords.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+
+    std::FILE* mFile;
+    SPSCRing<AuditRecord, AUDIT_RING_CAPACITY> mRing;
+    std::atomic<bool> mRunning{true};
+    std::atomic<unsigned long> mDroppedRecords{0};
+    std::thread mThread;
+};
+
+#endif //CPPREADY_TRADER_GO_AUDITLOG_H
@@ -15,13 +15,21 @@
 //     You should have received a copy of the GNU Affero General Public
 //     License along with Ready Trader Go.  If not, see
 //     <https://www.gnu.org/licenses/>.
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
 
 #include <boost/asio/io_context.hpp>
 
 #include <ready_trader_go/logging.h>
 
 #include "autotrader.h"
+#include "sessionfile.h"
 
 using namespace ReadyTraderGo;
 
@@ -29,25 +37,201 @@ RTG_INLINE_GLOBAL_LOGGER_WITH_CHANNEL(LG_AT, "AUTO")
 
 constexpr int LOT_SIZE = 10;
 constexpr int POSITION_LIMIT = 100;
+constexpr int UNHEDGED_LOTS_LIMIT = 10;
 constexpr int TICK_SIZE_IN_CENTS = 100;
 constexpr int MIN_BID_NEARST_TICK = (MINIMUM_BID + TICK_SIZE_IN_CENTS) / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
 constexpr int MAX_ASK_NEAREST_TICK = MAXIMUM_ASK / TICK_SIZE_IN_CENTS * TICK_SIZE_IN_CENTS;
+constexpr float MAX_SIGNAL_SKEW_TICKS = 2.0f;
 
-AutoTrader::AutoTrader(boost::asio::io_context& context) : BaseAutoTrader(context)
+template<typename T>
+static bool WriteValue(std::ostream& stream, const T& value)
 {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(stream.write(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+template<typename T>
+static bool ReadValue(std::istream& stream, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static unsigned long SkewPrice(unsigned long price, signed long skew)
+{
+    return price != 0 ? static_cast<unsigned long>(static_cast<signed long>(price) + skew) : 0;
+}
+
+// Why a side's cross got no order. The pacer only ever sees re-quotes that
+// the kernel and exposure model allowed, so it is checked first; then a
+// live order of ours already at the price, then the kernel's position
+// limit, which leaves the exposure model.
+static MissReason MissReasonFor(bool inserted, bool paced, bool working, signed long kernelInsert)
+{
+    if (inserted)
+    {
+        return MissReason::TAKEN;
+    }
+    if (!paced)
+    {
+        return MissReason::MESSAGE_BUDGET;
+    }
+    if (working)
+    {
+        return MissReason::ORDER_IN_FLIGHT;
+    }
+    return (kernelInsert == 0) ? MissReason::POSITION_LIMIT : MissReason::EXPOSURE_LIMIT;
+}
+
+// Loaded before the AutoTrader's members are constructed so that Analytics
+// can restore its share before its thread starts.
+static WarmState LoadWarmState(const std::string& filename)
+{
+    WarmState warmState;
+    std::string error;
+    if (filename.empty())
+    {
+        return warmState;
+    }
+    if (warmState.Load(filename, error))
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "loaded " << warmState.Size() << " warm state sections from "
+                                       << filename;
+    }
+    else
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "starting cold: " << error;
+    }
+    return warmState;
+}
+
+static AuditReason AuditReasonFor(bool present, MissReason reason)
+{
+    if (!present)
+    {
+        return AuditReason::NO_CROSS;
+    }
+    switch (reason)
+    {
+    case MissReason::TAKEN:
+        return AuditReason::INSERTED;
+    case MissReason::POSITION_LIMIT:
+        return AuditReason::POSITION_LIMIT;
+    case MissReason::EXPOSURE_LIMIT:
+        return AuditReason::EXPOSURE_LIMIT;
+    case MissReason::ORDER_IN_FLIGHT:
+        return AuditReason::ORDER_IN_FLIGHT;
+    case MissReason::MESSAGE_BUDGET:
+        return AuditReason::MESSAGE_BUDGET;
+    }
+    return AuditReason::NO_CROSS;
+}
+
+AutoTrader::AutoTrader(boost::asio::io_context& context) : AutoTrader(context, AutoTraderConfig())
+{
+}
+
+AutoTrader::AutoTrader(boost::asio::io_context& context, const AutoTraderConfig& config)
+    : BaseAutoTrader(context),
+      mQuoteParameters(config.quoteParameters),
+      mExposure(POSITION_LIMIT, UNHEDGED_LOTS_LIMIT),
+      mWarmState(LoadWarmState(config.warmStateFilename)),
+      mAnalytics(mWarmState),
+      mWarmStateFilename(config.warmStateFilename),
+      mEventClock(config.eventClock)
+{
+    std::string error;
+    if (config.signalModelFilename.empty())
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "signal model disabled";
+    }
+    else if (mSignalModel.Load(config.signalModelFilename, error))
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "loaded signal model from " << config.signalModelFilename;
+    }
+    else
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "signal model disabled: " << error;
+    }
+
+    // The journal, audit and trace files share one name so that they sort
+    // together.
+    const std::string session = NewSessionName();
+    if (!config.journalDirectory.empty())
+    {
+        mJournal = JournalRecorder::Create(config.journalDirectory, session, error);
+        if (mJournal)
+        {
+            RLOG(LG_AT, LogLevel::LL_INFO) << "journaling session to " << config.journalDirectory;
+        }
+        mAudit = AuditRecorder::Create(config.journalDirectory, session, error);
+    }
+    if (!config.traceDirectory.empty())
+    {
+        mTracer = Tracer::Create(config.traceDirectory, session, error);
+        if (mTracer)
+        {
+            RLOG(LG_AT, LogLevel::LL_INFO) << "tracing handlers to " << config.traceDirectory;
+        }
+    }
 }
 
 void AutoTrader::DisconnectHandler()
 {
     BaseAutoTrader::DisconnectHandler();
+    if (mJournal)
+    {
+        mJournal->Disconnect();
+    }
     RLOG(LG_AT, LogLevel::LL_INFO) << "execution connection lost";
+    for (std::size_t i = 0; i < MISS_REASON_COUNT; ++i)
+    {
+        const auto reason = static_cast<MissReason>(i);
+        RLOG(LG_AT, LogLevel::LL_INFO) << "opportunities " << MissReasonName(reason) << ": "
+                                       << mOpportunities.Count(reason) << " for " << mOpportunities.Volume(reason)
+                                       << " lots worth " << mOpportunities.Value(reason) << " cents";
+    }
+    const RoundTripLedger::Totals& trips = mRoundTrips.SessionTotals();
+    RLOG(LG_AT, LogLevel::LL_INFO) << "round trips: " << trips.count << " for " << trips.volume << " lots, "
+                                   << trips.hedgeVolume << " hedged, spread capture " << trips.spreadCapture
+                                   << " cents, hedge slippage " << trips.slippage << " cents, time to hedge "
+                                   << (trips.hedgedCount != 0 ? trips.timeToHedge.count() / trips.hedgedCount : 0)
+                                   << " ns";
+    const unsigned long heapFrames = WorkflowFramePool::Local().HeapFallbacks();
+    if (heapFrames != 0)
+    {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << heapFrames << " workflow frames exceeded "
+                                          << WORKFLOW_FRAME_SIZE << " bytes and were allocated from the heap";
+    }
+
+    // The session is over, so analytics may be stopped to take its state.
+    mAnalytics.Stop();
+    if (mWarmStateFilename.empty())
+    {
+        return;
+    }
+    mAnalytics.SaveWarmState(mWarmState);
+    std::string error;
+    if (mWarmState.Save(mWarmStateFilename, error))
+    {
+        RLOG(LG_AT, LogLevel::LL_INFO) << "saved warm state to " << mWarmStateFilename;
+    }
+    else
+    {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << "cannot save warm state: " << error;
+    }
 }
 
 void AutoTrader::ErrorMessageHandler(unsigned long clientOrderId,
                                      const std::string& errorMessage)
 {
+    const TraceScope trace(mTracer.get(), TraceName::ERROR, Instrument::ETF, clientOrderId);
     RLOG(LG_AT, LogLevel::LL_INFO) << "error with order " << clientOrderId << ": " << errorMessage;
-    if (clientOrderId != 0 && ((mAsks.count(clientOrderId) == 1) || (mBids.count(clientOrderId) == 1)))
+    if (mJournal)
+    {
+        mJournal->Error(clientOrderId);
+    }
+    if (clientOrderId != 0 && mWorkflows.Contains(clientOrderId))
     {
         OrderStatusMessageHandler(clientOrderId, 0, 0, 0);
     }
@@ -57,8 +241,14 @@ void AutoTrader::HedgeFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "hedge order " << clientOrderId << " filled for " << volume
-                                   << " lots at $" << price << " average price in cents";
+    const TraceScope trace(mTracer.get(), TraceName::HEDGE_FILLED, Instrument::FUTURE, clientOrderId);
+    mEventTime = Now();
+    if (mJournal)
+    {
+        mJournal->HedgeFilled(clientOrderId, price, volume);
+    }
+    mAnalytics.HedgeFilled(clientOrderId, price, volume);
+    mWorkflows.HedgeFilled(clientOrderId, price, volume);
 }
 
 void AutoTrader::OrderBookMessageHandler(Instrument instrument,
@@ -68,98 +258,151 @@ void AutoTrader::OrderBookMessageHandler(Instrument instrument,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "order book received for " << instrument << " instrument"
-                                   << ": ask prices: " << askPrices[0]
-                                   << "; ask volumes: " << askVolumes[0]
-                                   << "; bid prices: " << bidPrices[0]
-                                   << "; bid volumes: " << bidVolumes[0];
+    const TraceScope trace(mTracer.get(), TraceName::ORDER_BOOK, instrument, 0);
+    mEventTime = Now();
+    if (mJournal)
+    {
+        mJournal->OrderBook(instrument, sequenceNumber, askPrices, askVolumes, bidPrices, bidVolumes);
+    }
+    mAnalytics.OrderBook(instrument, sequenceNumber, askPrices, askVolumes, bidPrices, bidVolumes);
+    mFeatures.OrderBook(instrument, askPrices, askVolumes, bidPrices, bidVolumes);
+    mBookSignals.OrderBook(instrument, askPrices, askVolumes, bidPrices, bidVolumes);
+    const signed long skew = SignalSkew() + mBookSignals[Instrument::FUTURE].micropriceOffset;
     if (instrument == Instrument::ETF)
     {
         mETFAskPrice = askPrices[0];
         mETFBidPrice = bidPrices[0];
-        unsigned long newAskPrice = (mFutBidPrice > mETFAskPrice) && (mFutBidPrice != 0) ? mETFAskPrice : 0;
-        unsigned long newBidPrice = (mFutAskPrice < mETFBidPrice) && (mFutAskPrice != 0) ? mETFBidPrice : 0;
-        if (mAskId != 0 && newAskPrice != 0 && newAskPrice != mAskPrice)
-        {
-            SendCancelOrder(mAskId);
-            mAskId = 0;
-        }
-        if (mBidId != 0 && newBidPrice != 0 && newBidPrice != mBidPrice)
-        {
-            SendCancelOrder(mBidId);
-            mBidId = 0;
-        }
-        if (mBidId == 0 && newBidPrice != 0 && mPosition > -POSITION_LIMIT)
-        {
-            mBidId = mNextMessageId++;
-            mBidPrice = newBidPrice;
-            SendInsertOrder(mAskId, Side::SELL, mBidPrice, LOT_SIZE, Lifespan::GOOD_FOR_DAY);
-            mBids.emplace(mAskId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << " ETF Sell Order sent @ " << mBidPrice ;
-        }
-        if (mAskId == 0 && newAskPrice != 0 && mPosition < POSITION_LIMIT)
-        {
-            mAskId = mNextMessageId++;
-            mAskPrice = newAskPrice;
-            SendInsertOrder(mAskId, Side::BUY, newAskPrice, LOT_SIZE, Lifespan::GOOD_FOR_DAY);
-            mAsks.emplace(mAskId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << " ETF Buy Order sent @ " << mBidPrice ;
-        }
     }
     if (instrument == Instrument::FUTURE)
     {
         mFutAskPrice = askPrices[0];
         mFutBidPrice = bidPrices[0];
-        unsigned long newAskPrice = (mFutBidPrice > mETFAskPrice) && (mETFAskPrice != 0) ? mETFAskPrice : 0;
-        unsigned long newBidPrice = (mFutAskPrice < mETFBidPrice) && (mETFBidPrice != 0) ? mETFBidPrice : 0;
-        if (mAskId != 0 && newAskPrice != 0 && newAskPrice != mAskPrice)
+    }
+
+    QuoteInputs inputs;
+    inputs.etfAskPrice = mETFAskPrice;
+    inputs.etfBidPrice = mETFBidPrice;
+    inputs.futAskPrice = SkewPrice(mFutAskPrice, skew);
+    inputs.futBidPrice = SkewPrice(mFutBidPrice, skew);
+    inputs.futAskVolume = askVolumes[0];
+    inputs.futBidVolume = bidVolumes[0];
+    PlaceETFQuotes(mBookSignals[Instrument::ETF], mETFAskPrice, mETFBidPrice,
+                   inputs.etfAskQuotePrice, inputs.etfBidQuotePrice);
+    inputs.etfUpdate = instrument == Instrument::ETF;
+    const QuoteMarket market = PrepareQuoteMarket(inputs);
+    const QuoteState state{mAskPrice, mBidPrice, mAskId != 0, mBidId != 0, mExposure.ETFPosition()};
+    const unsigned long askHeadroom = mExposure.InsertHeadroom(Side::BUY);
+    const unsigned long bidHeadroom = mExposure.InsertHeadroom(Side::SELL);
+    const QuoteKey key{market, state, askHeadroom, bidHeadroom, mNextMessageId};
+    const unsigned long inputsHash = mAudit ? QuoteKeyHash(key) : 0;
+    const bool skip = mQuoteEarlyOut.Unchanged(key);
+    mAnalytics.QuoteEvaluated(skip);
+    if (skip)
+    {
+        Audit(instrument, inputsHash, AUDIT_SKIPPED, AuditReason::UNCHANGED, AuditReason::UNCHANGED);
+        return;
+    }
+    const QuoteDecision decision = DecideQuotes(mQuoteParameters, market, state);
+
+    // Orders are cut to whatever the exposure model says both position
+    // limits still allow, and left out when that is nothing.
+    const unsigned long bidVolume = std::min(static_cast<unsigned long>(decision.bidVolume), bidHeadroom);
+    const unsigned long askVolume = std::min(static_cast<unsigned long>(decision.askVolume), askHeadroom);
+
+    // Each side's re-quote then has to earn its messages. A deferred side
+    // is evaluated again on the next book even if nothing has changed.
+    const signed long askEdge = market.futBidPrice - static_cast<signed long>(decision.newAskPrice);
+    const signed long bidEdge = static_cast<signed long>(decision.newBidPrice) - market.futAskPrice;
+    const PacingDecision paced = mPacer.Admit(mEventTime,
+                                              PaceQuote(decision.cancelAsk, decision.insertAsk, askVolume, askEdge),
+                                              PaceQuote(decision.cancelBid, decision.insertBid, bidVolume, bidEdge));
+    if (!paced.ask || !paced.bid)
+    {
+        mQuoteEarlyOut.Invalidate();
+        mAnalytics.QuoteDeferred();
+    }
+
+    // What happened to each side's cross, if there was one.
+    const bool insertAsk = decision.insertAsk && askVolume != 0 && paced.ask;
+    const bool insertBid = decision.insertBid && bidVolume != 0 && paced.bid;
+    const MissReason askMiss = MissReasonFor(insertAsk, paced.ask,
+                                             state.askLive && decision.newAskPrice == state.askPrice,
+                                             decision.insertAsk);
+    const MissReason bidMiss = MissReasonFor(insertBid, paced.bid,
+                                             state.bidLive && decision.newBidPrice == state.bidPrice,
+                                             decision.insertBid);
+    TrackOpportunity(Side::BUY, decision.newAskPrice != 0, decision.askVolume, askEdge, askMiss);
+    TrackOpportunity(Side::SELL, decision.newBidPrice != 0, decision.bidVolume, bidEdge, bidMiss);
+
+    unsigned char action = 0;
+    if (decision.cancelAsk && paced.ask)
+    {
+        CancelOrder(mAskId);
+        mAskId = 0;
+        action |= AUDIT_CANCEL_ASK;
+    }
+    if (decision.cancelBid && paced.bid)
+    {
+        CancelOrder(mBidId);
+        mBidId = 0;
+        action |= AUDIT_CANCEL_BID;
+    }
+    if (instrument == Instrument::ETF)
+    {
+        if (insertBid)
         {
-            SendCancelOrder(mAskId);
-            mAskId = 0;
+            mBidId = mNextMessageId++;
+            mBidPrice = decision.newBidPrice;
+            InsertOrder(mBidId, Side::SELL, mBidPrice, bidVolume, Lifespan::GOOD_FOR_DAY);
+            OrderWorkflow(mBidId, {Side::SELL, bidVolume, false, 0});
         }
-        if (mBidId != 0 && newBidPrice != 0 && newBidPrice != mBidPrice)
+        if (insertAsk)
         {
-            SendCancelOrder(mBidId);
-            mBidId = 0;
+            mAskId = mNextMessageId++;
+            mAskPrice = decision.newAskPrice;
+            InsertOrder(mAskId, Side::BUY, mAskPrice, askVolume, Lifespan::GOOD_FOR_DAY);
+            OrderWorkflow(mAskId, {Side::BUY, askVolume, false, 0});
         }
-        if (mBidId == 0 && newBidPrice != 0 && mPosition > -POSITION_LIMIT )
+    }
+    if (instrument == Instrument::FUTURE)
+    {
+        if (insertBid)
         {
             mBidId = mNextMessageId++;
-            mBidPrice = newBidPrice;
-            SendInsertOrder(mBidId, Side::SELL, mBidPrice, bidVolumes[0], Lifespan::GOOD_FOR_DAY);
-            mBids.emplace(mBidId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << " ETF Sell Order sent @ " << mBidPrice ;
-            futAsks.insert({mBidId , mFutAskPrice});
+            mBidPrice = decision.newBidPrice;
+            InsertOrder(mBidId, Side::SELL, mBidPrice, bidVolume, Lifespan::GOOD_FOR_DAY);
+            OrderWorkflow(mBidId, {Side::SELL, bidVolume, true, mFutAskPrice});
         }
-        if (mAskId == 0 && newAskPrice != 0 && mPosition < POSITION_LIMIT)
+        if (insertAsk)
         {
             mAskId = mNextMessageId++;
-            mAskPrice = newAskPrice;
-            SendInsertOrder(mAskId, Side::BUY, newAskPrice, askVolumes[0], Lifespan::GOOD_FOR_DAY);
-            mAsks.emplace(mAskId);
-            RLOG(LG_AT, LogLevel::LL_INFO) << " ETF Buy Order sent @ " << mBidPrice ;
-            futBids.insert({mAskId, mFutBidPrice});
+            mAskPrice = decision.newAskPrice;
+            InsertOrder(mAskId, Side::BUY, mAskPrice, askVolume, Lifespan::GOOD_FOR_DAY);
+            OrderWorkflow(mAskId, {Side::BUY, askVolume, true, mFutBidPrice});
         }
     }
+    if (insertAsk)
+    {
+        action |= AUDIT_INSERT_ASK;
+    }
+    if (insertBid)
+    {
+        action |= AUDIT_INSERT_BID;
+    }
+    Audit(instrument, inputsHash, action, AuditReasonFor(decision.newAskPrice != 0, askMiss),
+          AuditReasonFor(decision.newBidPrice != 0, bidMiss));
 }
 void AutoTrader::OrderFilledMessageHandler(unsigned long clientOrderId,
                                            unsigned long price,
                                            unsigned long volume)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "order " << clientOrderId << " filled for " << volume
-                                   << " lots at $" << price << " cents";
-    if (mBids.count(clientOrderId) == 1)
+    const TraceScope trace(mTracer.get(), TraceName::ORDER_FILLED, Instrument::ETF, clientOrderId);
+    mEventTime = Now();
+    if (mJournal)
     {
-        mPosition -= (long)volume;
-        auto it = futAsks.find(clientOrderId);
-        SendHedgeOrder(mNextMessageId++, Side::BUY, it->second, volume);
-    }
-    else if (mAsks.count(clientOrderId) == 1)
-    {
-        mPosition += (long)volume;
-        auto it = futBids.find(clientOrderId);
-        SendHedgeOrder(mNextMessageId++, Side::SELL, it->second, volume);
+        mJournal->OrderFilled(clientOrderId, price, volume);
     }
+    mWorkflows.OrderFilled(clientOrderId, price, volume);
 }
 
 //void AutoTrader::OrderBookMessageHandler(Instrument instrument,
@@ -232,6 +475,11 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
                                            unsigned long remainingVolume,
                                            signed long fees)
 {
+    const TraceScope trace(mTracer.get(), TraceName::ORDER_STATUS, Instrument::ETF, clientOrderId);
+    if (mJournal)
+    {
+        mJournal->OrderStatus(clientOrderId, fillVolume, remainingVolume, fees);
+    }
     if (remainingVolume == 0)
     {
         if (clientOrderId == mAskId)
@@ -242,10 +490,8 @@ void AutoTrader::OrderStatusMessageHandler(unsigned long clientOrderId,
         {
             mBidId = 0;
         }
-
-        mAsks.erase(clientOrderId);
-        mBids.erase(clientOrderId);
     }
+    mWorkflows.OrderStatus(clientOrderId, fillVolume, remainingVolume);
 }
 
 void AutoTrader::TradeTicksMessageHandler(Instrument instrument,
@@ -255,9 +501,322 @@ void AutoTrader::TradeTicksMessageHandler(Instrument instrument,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
                                           const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
 {
-    RLOG(LG_AT, LogLevel::LL_INFO) << "trade ticks received for " << instrument << " instrument"
-                                   << ": ask prices: " << askPrices[0]
-                                   << "; ask volumes: " << askVolumes[0]
-                                   << "; bid prices: " << bidPrices[0]
-                                   << "; bid volumes: " << bidVolumes[0];
+    const TraceScope trace(mTracer.get(), TraceName::TRADE_TICKS, instrument, 0);
+    mEventTime = Now();
+    if (mJournal)
+    {
+        mJournal->TradeTicks(instrument, sequenceNumber, askPrices, askVolumes, bidPrices, bidVolumes);
+    }
+
+    // Pull a quote that an aggressive sweep is about to run through before
+    // it is picked off: buyers lifting the asks threaten our sell, and
+    // sellers hitting the bids our buy. These cancels are never paced.
+    const SweepSignal sweep = mSweepDetector.TradeTicks(instrument, mEventTime, askPrices, askVolumes, bidPrices,
+                                                        bidVolumes);
+    unsigned char action = 0;
+    if (sweep.up && mBidId != 0)
+    {
+        CancelOrder(mBidId);
+        mBidId = 0;
+        action |= AUDIT_SWEEP | AUDIT_CANCEL_BID;
+    }
+    if (sweep.down && mAskId != 0)
+    {
+        CancelOrder(mAskId);
+        mAskId = 0;
+        action |= AUDIT_SWEEP | AUDIT_CANCEL_ASK;
+    }
+    if (action != 0)
+    {
+        Audit(instrument, 0, action,
+              (action & AUDIT_CANCEL_ASK) ? AuditReason::SWEEP : AuditReason::UNCHANGED,
+              (action & AUDIT_CANCEL_BID) ? AuditReason::SWEEP : AuditReason::UNCHANGED);
+    }
+    mAnalytics.TradeTicks(instrument, sequenceNumber, askPrices, askVolumes, bidPrices, bidVolumes);
+    mFeatures.TradeTicks(instrument, askVolumes, bidVolumes);
+}
+
+Workflow AutoTrader::OrderWorkflow(unsigned long clientOrderId, OrderWorkflowState state)
+{
+    OrderExposure exposure(mExposure, state.side, state.volume);
+    for (;;)
+    {
+        const OrderEvent event = co_await mWorkflows.NextOrderEvent(clientOrderId, &state);
+        if (event.type == OrderEvent::Type::STATUS)
+        {
+            if (event.remainingVolume == 0)
+            {
+                co_return;
+            }
+            continue;
+        }
+
+        exposure.Filled(event.volume);
+        state.volume = exposure.Remaining();
+        HedgeFill(clientOrderId, state, event);
+    }
+}
+
+void AutoTrader::HedgeFill(unsigned long orderId, const OrderWorkflowState& order, const OrderEvent& fill)
+{
+    HedgeWorkflowState hedge;
+    hedge.side = (order.side == Side::BUY) ? Side::SELL : Side::BUY;
+    hedge.price = order.hedgeReferenced ? order.hedgePrice : (order.side == Side::BUY) ? mFutBidPrice : mFutAskPrice;
+    hedge.volume = fill.volume;
+    hedge.hedgeVolume = std::min(fill.volume, mExposure.HedgeHeadroom(hedge.side));
+    hedge.orderId = orderId;
+    hedge.fillPrice = fill.price;
+    hedge.filled = mEventTime;
+    hedge.traceBegin = 0;
+    const unsigned long hedgeId = mNextMessageId++;
+    if (hedge.hedgeVolume == 0)
+    {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << "hedge order " << hedgeId << " for " << hedge.volume
+                                          << " lots withheld at the future position limit";
+        RecordRoundTrip(hedge, 0, HedgeResult());
+    }
+    else
+    {
+        hedge.traceBegin = mTracer ? Tracer::Now() : 0;
+        HedgeOrder(hedgeId, hedge.side, hedge.price, hedge.hedgeVolume);
+        mExposure.HedgeSent(hedge.side, hedge.hedgeVolume);
+        HedgeWorkflow(hedgeId, hedge);
+    }
+    mAnalytics.OrderFilled(orderId, order.side, fill.price, fill.volume, (hedge.hedgeVolume != 0) ? hedgeId : 0);
+}
+
+Workflow AutoTrader::HedgeWorkflow(unsigned long clientOrderId, HedgeWorkflowState state)
+{
+    const HedgeResult result = co_await mWorkflows.HedgeFilled(clientOrderId, &state);
+    CompleteHedge(clientOrderId, state, result);
+}
+
+void AutoTrader::CompleteHedge(unsigned long clientOrderId, const HedgeWorkflowState& hedge,
+                               const HedgeResult& result)
+{
+    if (mTracer)
+    {
+        TraceSpan span;
+        span.name = TraceName::HEDGE;
+        span.instrument = Instrument::FUTURE;
+        span.orderId = clientOrderId;
+        span.begin = hedge.traceBegin;
+        span.end = Tracer::Now();
+        mTracer->Record(span);
+    }
+    mExposure.HedgeCompleted(hedge.side, hedge.hedgeVolume, result.volume);
+    RecordRoundTrip(hedge, clientOrderId, result);
+    if (result.volume == 0)
+    {
+        RLOG(LG_AT, LogLevel::LL_WARNING) << "hedge order " << clientOrderId << " for " << hedge.hedgeVolume
+                                          << " lots at " << hedge.price << " cents was not filled";
+    }
+}
+
+signed long AutoTrader::SignalSkew()
+{
+    if (!mSignalModel.Enabled() || !mFeatures.Valid())
+    {
+        return 0;
+    }
+
+    mFeatures.Compute(mFeatureVector);
+    const float prediction = mSignalModel.Evaluate(mFeatureVector);
+    if (!std::isfinite(prediction))
+    {
+        // Finite weights can still overflow on extreme features, and NaN
+        // would pass through the clamp into an undefined conversion.
+        return 0;
+    }
+    float ticks = std::round(prediction);
+    ticks = std::clamp(ticks, -MAX_SIGNAL_SKEW_TICKS, MAX_SIGNAL_SKEW_TICKS);
+    return static_cast<signed long>(ticks) * TICK_SIZE_IN_CENTS;
+}
+
+void AutoTrader::TrackOpportunity(Side side, bool present, signed long size, signed long edge, MissReason reason)
+{
+    Opportunity finished;
+    if (mOpportunities.Observe(side, mEventTime, present, static_cast<unsigned long>(size), edge, reason, finished)
+        && mJournal)
+    {
+        mJournal->Opportunity(finished.side, static_cast<unsigned long>(finished.reason),
+                              static_cast<unsigned long>(finished.edge), finished.size, finished.evaluations,
+                              finished.duration);
+    }
+}
+
+void AutoTrader::Audit(Instrument instrument,
+                       unsigned long inputsHash,
+                       unsigned char action,
+                       AuditReason askReason,
+                       AuditReason bidReason)
+{
+    if (!mAudit)
+    {
+        return;
+    }
+    AuditRecord record;
+    record.timestamp = mEventTime.count();
+    record.inputsHash = inputsHash;
+    record.askId = mAskId;
+    record.bidId = mBidId;
+    record.instrument = instrument;
+    record.action = action;
+    record.askReason = askReason;
+    record.bidReason = bidReason;
+    mAudit->Record(record);
+}
+
+void AutoTrader::RecordRoundTrip(const HedgeWorkflowState& hedge, unsigned long hedgeId, const HedgeResult& result)
+{
+    RoundTrip trip;
+    trip.orderId = hedge.orderId;
+    trip.hedgeId = hedgeId;
+    trip.side = (hedge.side == Side::BUY) ? Side::SELL : Side::BUY;
+    trip.price = hedge.fillPrice;
+    trip.volume = hedge.volume;
+    trip.referencePrice = hedge.price;
+    trip.hedgePrice = result.price;
+    trip.hedgeVolume = result.volume;
+    trip.filled = hedge.filled;
+    trip.hedged = mEventTime;
+    mRoundTrips.Record(trip);
+    if (mJournal)
+    {
+        mJournal->RoundTrip(trip.orderId, trip.hedgeId, trip.side, trip.price, trip.volume, trip.referencePrice,
+                            trip.hedgePrice, trip.hedgeVolume, trip.TimeToHedge());
+    }
+}
+
+bool AutoTrader::SaveState(std::ostream& stream) const
+{
+    bool ok = WriteValue(stream, mNextMessageId) && WriteValue(stream, mAskId) && WriteValue(stream, mFutAskPrice)
+              && WriteValue(stream, mETFAskPrice) && WriteValue(stream, mBidId) && WriteValue(stream, mFutBidPrice)
+              && WriteValue(stream, mETFBidPrice) && WriteValue(stream, mQuoteParameters)
+              && WriteValue(stream, mExposure) && WriteValue(stream, mQuoteEarlyOut) && WriteValue(stream, mPacer)
+              && WriteValue(stream, mOpportunities) && WriteValue(stream, mRoundTrips)
+              && WriteValue(stream, mEventTime) && WriteValue(stream, mAskPrice) && WriteValue(stream, mBidPrice)
+              && WriteValue(stream, mFeatures) && WriteValue(stream, mSweepDetector)
+              && WriteValue(stream, mBookSignals);
+
+    const auto orders = mWorkflows.WaitingOrders();
+    ok = ok && WriteValue(stream, orders.size());
+    for (const auto& [clientOrderId, state] : orders)
+    {
+        ok = ok && WriteValue(stream, clientOrderId)
+             && WriteValue(stream, *static_cast<const OrderWorkflowState*>(state));
+    }
+    const auto hedges = mWorkflows.WaitingHedges();
+    ok = ok && WriteValue(stream, hedges.size());
+    for (const auto& [clientOrderId, state] : hedges)
+    {
+        ok = ok && WriteValue(stream, clientOrderId)
+             && WriteValue(stream, *static_cast<const HedgeWorkflowState*>(state));
+    }
+    return ok;
+}
+
+bool AutoTrader::LoadState(std::istream& stream)
+{
+    if (!mWorkflows.WaitingOrders().empty() || !mWorkflows.WaitingHedges().empty())
+    {
+        return false;
+    }
+    if (!ReadValue(stream, mNextMessageId) || !ReadValue(stream, mAskId) || !ReadValue(stream, mFutAskPrice)
+        || !ReadValue(stream, mETFAskPrice) || !ReadValue(stream, mBidId) || !ReadValue(stream, mFutBidPrice)
+        || !ReadValue(stream, mETFBidPrice) || !ReadValue(stream, mQuoteParameters)
+        || !ReadValue(stream, mExposure) || !ReadValue(stream, mQuoteEarlyOut) || !ReadValue(stream, mPacer)
+        || !ReadValue(stream, mOpportunities) || !ReadValue(stream, mRoundTrips)
+        || !ReadValue(stream, mEventTime) || !ReadValue(stream, mAskPrice) || !ReadValue(stream, mBidPrice)
+        || !ReadValue(stream, mFeatures) || !ReadValue(stream, mSweepDetector) || !ReadValue(stream, mBookSignals))
+    {
+        return false;
+    }
+
+    // The exposure model already holds each live order's volume, which
+    // its restarted workflow takes again.
+    std::size_t count = 0;
+    if (!ReadValue(stream, count))
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        unsigned long clientOrderId = 0;
+        OrderWorkflowState state{};
+        if (!ReadValue(stream, clientOrderId) || !ReadValue(stream, state))
+        {
+            return false;
+        }
+        mExposure.OrderReleased(state.side, state.volume);
+        OrderWorkflow(clientOrderId, state);
+    }
+    if (!ReadValue(stream, count))
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        unsigned long clientOrderId = 0;
+        HedgeWorkflowState state{};
+        if (!ReadValue(stream, clientOrderId) || !ReadValue(stream, state))
+        {
+            return false;
+        }
+        HedgeWorkflow(clientOrderId, state);
+    }
+    return true;
+}
+
+std::chrono::nanoseconds AutoTrader::Now() const noexcept
+{
+    if (mEventClock)
+    {
+        return *mEventClock;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void AutoTrader::CancelOrder(unsigned long clientOrderId)
+{
+    {
+        const TraceScope trace(mTracer.get(), TraceName::CANCEL_ORDER, Instrument::ETF, clientOrderId);
+        SendCancelOrder(clientOrderId);
+    }
+    mPacer.Sent(mEventTime);
+    if (mJournal)
+    {
+        mJournal->CancelOrder(clientOrderId);
+    }
+}
+
+void AutoTrader::HedgeOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+{
+    {
+        const TraceScope trace(mTracer.get(), TraceName::HEDGE_ORDER, Instrument::FUTURE, clientOrderId);
+        SendHedgeOrder(clientOrderId, side, price, volume);
+    }
+    mPacer.Sent(mEventTime);
+    if (mJournal)
+    {
+        mJournal->HedgeOrder(clientOrderId, side, price, volume);
+    }
+}
+
+void AutoTrader::InsertOrder(unsigned long clientOrderId,
+                             Side side,
+                             unsigned long price,
+                             unsigned long volume,
+                             Lifespan lifespan)
+{
+    {
+        const TraceScope trace(mTracer.get(), TraceName::INSERT_ORDER, Instrument::ETF, clientOrderId);
+        SendInsertOrder(clientOrderId, side, price, volume, lifespan);
+    }
+    mPacer.Sent(mEventTime);
+    if (mJournal)
+    {
+        mJournal->InsertOrder(clientOrderId, side, price, volume, lifespan);
+    }
 }
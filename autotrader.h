@@ -19,20 +19,55 @@
 #define CPPREADY_TRADER_GO_AUTOTRADER_H
 
 #include <array>
+#include <chrono>
+#include <iosfwd>
 #include <memory>
 #include <string>
-#include <unordered_set>
-#include <unordered_map>
 
 #include <boost/asio/io_context.hpp>
 
 #include <ready_trader_go/baseautotrader.h>
 #include <ready_trader_go/types.h>
 
+#include "analytics.h"
+#include "auditlog.h"
+#include "booksignal.h"
+#include "exposure.h"
+#include "journal.h"
+#include "messagepacer.h"
+#include "opportunitytracker.h"
+#include "orderworkflow.h"
+#include "quotekernel.h"
+#include "roundtrip.h"
+#include "signalfeatures.h"
+#include "signalmodel.h"
+#include "sweepdetector.h"
+#include "tracing.h"
+#include "warmstate.h"
+
+// How an AutoTrader is set up. The defaults are the competition trader's.
+// An empty file or directory name turns that file off; the replay and
+// simulation tools turn off everything but the signal model and supply
+// the event clock.
+struct AutoTraderConfig
+{
+    QuoteParameters quoteParameters;
+    std::string signalModelFilename = "signal_model.bin";
+    std::string journalDirectory = "journals"; // the audit trail goes here too
+    std::string traceDirectory = "traces";
+    std::string warmStateFilename = "warm_state.bin";
+
+    // If set, the handlers take the event time from here rather than from
+    // the steady clock, so that the trader decides as it would have at the
+    // times a replay or simulation gives it.
+    const std::chrono::nanoseconds* eventClock = nullptr;
+};
+
 class AutoTrader : public ReadyTraderGo::BaseAutoTrader
 {
 public:
     explicit AutoTrader(boost::asio::io_context& context);
+    AutoTrader(boost::asio::io_context& context, const AutoTraderConfig& config);
 
     // Called when the execution connection is lost.
     void DisconnectHandler() override;
@@ -94,7 +129,99 @@ public:
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
                                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) override;
 
+    // The positions the trader's fills have given it.
+    signed long ETFPosition() const noexcept { return mExposure.ETFPosition(); }
+    signed long FuturePosition() const noexcept { return mExposure.FuturePosition(); }
+
+    // Write everything the trader's sends depend on, live order and hedge
+    // workflows included, or restore it into a trader that has received no
+    // messages since it was constructed with the same config. Analytics,
+    // the signal model and the output files are left out. The format is
+    // this build's memory layout, so only the same build should read it
+    // back.
+    bool SaveState(std::ostream& stream) const;
+    bool LoadState(std::istream& stream);
+
 private:
+    // What a live workflow holds in its frame, registered with the
+    // dispatcher while it waits so that SaveState can find it and LoadState
+    // can start an equivalent workflow.
+    struct OrderWorkflowState
+    {
+        ReadyTraderGo::Side side;
+        unsigned long volume; // still held against the exposure model
+        bool hedgeReferenced;
+        unsigned long hedgePrice;
+    };
+
+    struct HedgeWorkflowState
+    {
+        ReadyTraderGo::Side side;
+        unsigned long price;
+        unsigned long volume; // of the ETF fill being hedged
+        unsigned long hedgeVolume;
+        unsigned long orderId;
+        unsigned long fillPrice;
+        std::chrono::nanoseconds filled;
+        signed long traceBegin;
+    };
+
+    // All outgoing order messages go through these so that they can be
+    // journaled alongside the inbound messages and counted against the
+    // message budget at the time of the event that caused them.
+    void CancelOrder(unsigned long clientOrderId);
+    void HedgeOrder(unsigned long clientOrderId,
+                    ReadyTraderGo::Side side,
+                    unsigned long price,
+                    unsigned long volume);
+    void InsertOrder(unsigned long clientOrderId,
+                     ReadyTraderGo::Side side,
+                     unsigned long price,
+                     unsigned long volume,
+                     ReadyTraderGo::Lifespan lifespan);
+
+    // Follow the cross on one side through this evaluation, journaling the
+    // opportunity when it closes.
+    void TrackOpportunity(ReadyTraderGo::Side side, bool present, signed long size, signed long edge,
+                          MissReason reason);
+
+    // Write the outcome of one quote evaluation, or of a sweep pull, to the
+    // audit trail with the order ids left live by it.
+    void Audit(ReadyTraderGo::Instrument instrument,
+               unsigned long inputsHash,
+               unsigned char action,
+               AuditReason askReason,
+               AuditReason bidReason);
+
+    // Monotonic time in nanoseconds, or the configured event clock's, taken
+    // on entry to each handler that may send.
+    std::chrono::nanoseconds Now() const noexcept;
+
+    // The life of one of our ETF orders: its volume is held against the
+    // exposure model and each fill is hedged on the future until the order
+    // is finished. Without a hedge reference price the future's current
+    // price on the opposite side is used.
+    Workflow OrderWorkflow(unsigned long clientOrderId, OrderWorkflowState state);
+
+    // Send a hedge order for as much of an ETF fill as the future position
+    // limit allows, or withhold it if that is nothing, and start a hedge
+    // workflow to wait for its outcome. This and CompleteHedge run outside
+    // the workflows so that their locals do not grow the frames.
+    void HedgeFill(unsigned long orderId, const OrderWorkflowState& order, const OrderEvent& fill);
+
+    // Wait for the outcome of a hedge order, which completes the round
+    // trip begun by the ETF fill it hedges.
+    Workflow HedgeWorkflow(unsigned long clientOrderId, HedgeWorkflowState state);
+    void CompleteHedge(unsigned long clientOrderId, const HedgeWorkflowState& hedge, const HedgeResult& result);
+
+    // Add the round trip of an ETF fill and its hedge, which was withheld if
+    // hedgeId is zero, to the ledger and the journal.
+    void RecordRoundTrip(const HedgeWorkflowState& hedge, unsigned long hedgeId, const HedgeResult& result);
+
+    // Evaluate the signal model, if one is loaded, and return the resulting
+    // fair value adjustment to the future reference prices in cents.
+    signed long SignalSkew();
+
     unsigned long mNextMessageId = 1;
     unsigned long mAskId = 0;
     unsigned long mFutAskPrice = 0;
@@ -102,13 +229,28 @@ private:
     unsigned long mBidId = 0;
     unsigned long mFutBidPrice = 0;
     unsigned long mETFBidPrice = 0;
-    signed long mPosition = 0;
+    QuoteParameters mQuoteParameters;
+    ExposureModel mExposure;
+    QuoteEarlyOut mQuoteEarlyOut;
+    MessagePacer mPacer;
+    OpportunityTracker mOpportunities;
+    RoundTripLedger mRoundTrips;
+    std::chrono::nanoseconds mEventTime{0};
     unsigned  long  mAskPrice = 0;
     unsigned  long  mBidPrice = 0;
-    std::unordered_set<unsigned long> mAsks;
-    std::unordered_set<unsigned long> mBids;
-    std::unordered_map<unsigned long, unsigned long> futAsks;
-    std::unordered_map<unsigned long, unsigned long> futBids;
+    WorkflowDispatcher mWorkflows;
+    WarmState mWarmState;
+    Analytics mAnalytics;
+    SignalFeatures mFeatures;
+    alignas(32) FeatureVector mFeatureVector{};
+    SignalModel mSignalModel;
+    SweepDetector mSweepDetector;
+    BookSignals mBookSignals;
+    std::unique_ptr<JournalRecorder> mJournal;
+    std::unique_ptr<AuditRecorder> mAudit;
+    std::unique_ptr<Tracer> mTracer;
+    std::string mWarmStateFilename;
+    const std::chrono::nanoseconds* mEventClock;
 };
 
 #endif //CPPREADY_TRADER_GO_AUTOTRADER_H
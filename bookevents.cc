@@ -0,0 +1,187 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include "bookevents.h"
+
+using namespace ReadyTraderGo;
+
+// A side's levels as eight 32-bit lanes, of which the first
+// TOP_LEVEL_COUNT are used and the rest stay zero. Prices and volumes fit in
+// 32 bits. The lanes are held as two 128-bit halves because GCC splits a
+// 256-bit comparison into scalar code when AVX2 is not enabled.
+typedef unsigned int LevelHalf __attribute__((vector_size(16)));
+
+struct LevelVector
+{
+    LevelHalf low{};
+    LevelHalf high{};
+
+    unsigned int operator[](std::size_t i) const { return (i < 4) ? low[i] : high[i - 4]; }
+};
+
+static LevelVector Load(const std::array<unsigned long, TOP_LEVEL_COUNT>& values)
+{
+    LevelVector vector;
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+    {
+        const auto value = static_cast<unsigned int>(values[i]);
+        if (i < 4)
+        {
+            vector.low[i] = value;
+        }
+        else
+        {
+            vector.high[i - 4] = value;
+        }
+    }
+    return vector;
+}
+
+// For each lane of prices, whether the other side has a level at the same
+// price (all ones if so) and that level's volume.
+static void Match(const LevelVector& prices, const LevelVector& otherPrices, const LevelVector& otherVolumes,
+                  LevelVector& matched, LevelVector& matchedVolumes)
+{
+    matched = LevelVector{};
+    matchedVolumes = LevelVector{};
+    for (std::size_t j = 0; j < TOP_LEVEL_COUNT; ++j)
+    {
+        const unsigned int price = otherPrices[j];
+        const unsigned int volume = otherVolumes[j];
+        const auto low = reinterpret_cast<LevelHalf>(prices.low == price);
+        const auto high = reinterpret_cast<LevelHalf>(prices.high == price);
+        matched.low |= low;
+        matched.high |= high;
+        matchedVolumes.low |= low & volume;
+        matchedVolumes.high |= high & volume;
+    }
+}
+
+static unsigned long WorstPrice(const std::array<unsigned long, TOP_LEVEL_COUNT>& prices)
+{
+    unsigned long worst = 0;
+    for (unsigned long price : prices)
+    {
+        worst = (price != 0) ? price : worst;
+    }
+    return worst;
+}
+
+std::size_t BookEventInference::DiffSide(Side side, const Levels& previous, const Levels& current, BookEvent* events)
+{
+    // Bids improve upwards and asks downwards.
+    auto better = [side](unsigned long a, unsigned long b) { return (side == Side::BUY) ? a > b : a < b; };
+
+    const LevelVector previousPrices = Load(previous.prices);
+    const LevelVector previousVolumes = Load(previous.volumes);
+    const LevelVector currentPrices = Load(current.prices);
+
+    LevelVector currentMatched;
+    LevelVector matchedVolumes;
+    LevelVector previousMatched;
+    LevelVector unused;
+    const LevelVector none{};
+    Match(currentPrices, previousPrices, previousVolumes, currentMatched, matchedVolumes);
+    Match(previousPrices, currentPrices, none, previousMatched, unused);
+
+    const unsigned long previousBest = previous.prices[0];
+    const unsigned long currentBest = current.prices[0];
+    const bool previousFull = previous.prices[TOP_LEVEL_COUNT - 1] != 0;
+    const bool currentFull = current.prices[TOP_LEVEL_COUNT - 1] != 0;
+    const unsigned long previousWorst = WorstPrice(previous.prices);
+    const unsigned long currentWorst = WorstPrice(current.prices);
+
+    std::size_t count = 0;
+    if (previousBest != 0 && currentBest != 0 && previousBest != currentBest)
+    {
+        events[count++] = {BookEventType::SHIFT, side, currentBest, 0,
+                           static_cast<signed long>(currentBest) - static_cast<signed long>(previousBest)};
+    }
+
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+    {
+        const unsigned long price = current.prices[i];
+        if (price == 0)
+        {
+            break;
+        }
+        const unsigned long volume = current.volumes[i];
+        if (currentMatched[i] != 0)
+        {
+            const unsigned long before = matchedVolumes[i];
+            if (volume > before)
+            {
+                events[count++] = {BookEventType::ADD, side, price, volume - before, 0};
+            }
+            else if (volume < before)
+            {
+                const bool atTouch = i == 0 && price == previousBest;
+                events[count++] = {atTouch ? BookEventType::DEPLETE : BookEventType::CANCEL, side, price,
+                                   before - volume, 0};
+            }
+        }
+        else if (!previousFull || better(price, previousWorst))
+        {
+            events[count++] = {BookEventType::ADD, side, price, volume, 0};
+        }
+    }
+
+    for (std::size_t j = 0; j < TOP_LEVEL_COUNT; ++j)
+    {
+        const unsigned long price = previous.prices[j];
+        if (price == 0)
+        {
+            break;
+        }
+        if (previousMatched[j] != 0)
+        {
+            continue;
+        }
+        if (currentBest == 0 || better(price, currentBest))
+        {
+            events[count++] = {BookEventType::DEPLETE, side, price, previous.volumes[j], 0};
+        }
+        else if (!currentFull || better(price, currentWorst))
+        {
+            events[count++] = {BookEventType::CANCEL, side, price, previous.volumes[j], 0};
+        }
+    }
+    return count;
+}
+
+std::size_t BookEventInference::Update(Instrument instrument,
+                                       const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                       const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                       const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                       const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes,
+                                       BookEvents& events)
+{
+    Snapshot& previous = mPrevious[static_cast<std::size_t>(instrument)];
+    const Levels asks{askPrices, askVolumes};
+    const Levels bids{bidPrices, bidVolumes};
+
+    std::size_t count = 0;
+    if (previous.valid)
+    {
+        count += DiffSide(Side::SELL, previous.asks, asks, events.data());
+        count += DiffSide(Side::BUY, previous.bids, bids, events.data() + count);
+    }
+    previous.asks = asks;
+    previous.bids = bids;
+    previous.valid = true;
+    return count;
+}
@@ -0,0 +1,92 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_BOOKEVENTS_H
+#define CPPREADY_TRADER_GO_BOOKEVENTS_H
+
+#include <array>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+enum class BookEventType : unsigned char
+{
+    ADD,     // volume added at a price, including a new price level
+    CANCEL,  // volume removed away from the touch
+    DEPLETE, // volume removed at or through the touch, usually by trading
+    SHIFT    // the best price on a side moved
+};
+
+// One inferred change to a side of the book. The side is that of the
+// resting orders: SELL for the asks and BUY for the bids. For SHIFT the
+// price is the new best price, the volume is zero and priceChange is the
+// signed move in cents; otherwise priceChange is zero.
+struct BookEvent
+{
+    BookEventType type = BookEventType::ADD;
+    ReadyTraderGo::Side side = ReadyTraderGo::Side::BUY;
+    unsigned long price = 0;
+    unsigned long volume = 0;
+    signed long priceChange = 0;
+};
+
+// Per side, each visible level of either snapshot gives at most one event,
+// plus one for a shift of the best price.
+constexpr std::size_t MAX_BOOK_EVENTS = 2 * (2 * ReadyTraderGo::TOP_LEVEL_COUNT + 1);
+using BookEvents = std::array<BookEvent, MAX_BOOK_EVENTS>;
+
+// Infers the order book events between consecutive five-level snapshots of
+// each instrument, keeping only the previous snapshot.
+//
+// Levels are matched by price with a fixed number of vector comparisons,
+// each price of one snapshot against every lane of the other at once.
+// Changes beyond the visible depth cannot be seen: a level that scrolls into
+// or out of the top five because of a move elsewhere yields no event.
+class BookEventInference
+{
+public:
+    // Diff a snapshot against the last one for the same instrument, write
+    // the inferred events to events and return how many there are. The
+    // first snapshot of an instrument yields none.
+    std::size_t Update(ReadyTraderGo::Instrument instrument,
+                       const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                       const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                       const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                       const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes,
+                       BookEvents& events);
+
+private:
+    struct Levels
+    {
+        std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> prices{};
+        std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> volumes{};
+    };
+
+    struct Snapshot
+    {
+        Levels asks;
+        Levels bids;
+        bool valid = false;
+    };
+
+    static std::size_t DiffSide(ReadyTraderGo::Side side, const Levels& previous, const Levels& current,
+                                BookEvent* events);
+
+    std::array<Snapshot, 2> mPrevious;
+};
+
+#endif //CPPREADY_TRADER_GO_BOOKEVENTS_H
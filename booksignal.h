@@ -0,0 +1,111 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_BOOKSIGNAL_H
+#define CPPREADY_TRADER_GO_BOOKSIGNAL_H
+
+#include <array>
+
+#include <ready_trader_go/types.h>
+
+// Imbalances are fixed point with IMBALANCE_ONE standing for 1.0, and
+// microprices carry MICROPRICE_SHIFT fractional bits of a cent.
+constexpr signed long IMBALANCE_ONE = 1L << 15;
+constexpr int MICROPRICE_SHIFT = 8;
+
+// The ETF book must lean at least this far against one of our quotes for
+// it to be posted passively rather than taking the touch.
+constexpr signed long PLACEMENT_IMBALANCE = IMBALANCE_ONE / 3;
+constexpr unsigned long BOOK_SIGNAL_TICK_SIZE = 100;
+
+// Order book pressure on one instrument. Positive imbalances mean more
+// volume bid than offered.
+struct BookSignal
+{
+    bool valid = false;
+    signed long topImbalance = 0;   // best level only
+    signed long depthImbalance = 0; // all five levels, nearer levels weighted more
+    signed long microprice = 0;     // volume weighted toward the thinner side
+    signed long micropriceOffset = 0; // microprice less the mid, rounded to whole cents
+};
+
+// Imbalance and microprice for both instruments, updated from each order
+// book message in integer arithmetic with no allocation.
+class BookSignals
+{
+public:
+    void OrderBook(ReadyTraderGo::Instrument instrument,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) noexcept
+    {
+        BookSignal& signal = mSignals[static_cast<std::size_t>(instrument)];
+        const auto askTop = static_cast<signed long>(askVolumes[0]);
+        const auto bidTop = static_cast<signed long>(bidVolumes[0]);
+        signal.valid = askPrices[0] != 0 && bidPrices[0] != 0 && askTop + bidTop != 0;
+        if (!signal.valid)
+        {
+            signal = BookSignal{};
+            return;
+        }
+
+        signed long askDepth = 0;
+        signed long bidDepth = 0;
+        for (int i = 0; i < ReadyTraderGo::TOP_LEVEL_COUNT; ++i)
+        {
+            const signed long weight = ReadyTraderGo::TOP_LEVEL_COUNT - i;
+            askDepth += weight * static_cast<signed long>(askVolumes[i]);
+            bidDepth += weight * static_cast<signed long>(bidVolumes[i]);
+        }
+        signal.topImbalance = (bidTop - askTop) * IMBALANCE_ONE / (bidTop + askTop);
+        signal.depthImbalance = (bidDepth - askDepth) * IMBALANCE_ONE / (bidDepth + askDepth);
+
+        const auto ask = static_cast<signed long>(askPrices[0]);
+        const auto bid = static_cast<signed long>(bidPrices[0]);
+        signal.microprice = ((ask * bidTop + bid * askTop) << MICROPRICE_SHIFT) / (askTop + bidTop);
+        const signed long offset = signal.microprice - ((ask + bid) << (MICROPRICE_SHIFT - 1));
+        const signed long half = 1L << (MICROPRICE_SHIFT - 1);
+        signal.micropriceOffset = (offset >= 0) ? (offset + half) >> MICROPRICE_SHIFT
+                                                : -((-offset + half) >> MICROPRICE_SHIFT);
+    }
+
+    const BookSignal& operator[](ReadyTraderGo::Instrument instrument) const noexcept
+    {
+        return mSignals[static_cast<std::size_t>(instrument)];
+    }
+
+private:
+    std::array<BookSignal, 2> mSignals;
+};
+
+// Prices for our ETF buy and sell should the cross test want them. Each
+// takes the touch unless the ETF book leans against it, in which case it
+// is posted one tick inside the spread instead, which joins the opposite
+// best price when the spread is a single tick. Zero means take the touch.
+inline void PlaceETFQuotes(const BookSignal& etf,
+                           unsigned long etfAskPrice,
+                           unsigned long etfBidPrice,
+                           unsigned long& buyPrice,
+                           unsigned long& sellPrice) noexcept
+{
+    const bool twoSided = etf.valid && etfAskPrice != 0 && etfBidPrice != 0;
+    buyPrice = (twoSided && etf.topImbalance <= -PLACEMENT_IMBALANCE) ? etfAskPrice - BOOK_SIGNAL_TICK_SIZE : 0;
+    sellPrice = (twoSided && etf.topImbalance >= PLACEMENT_IMBALANCE) ? etfBidPrice + BOOK_SIGNAL_TICK_SIZE : 0;
+}
+
+#endif //CPPREADY_TRADER_GO_BOOKSIGNAL_H
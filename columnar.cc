@@ -0,0 +1,153 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "columnar.h"
+
+static std::uint64_t AlignOffset(std::uint64_t offset)
+{
+    return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+}
+
+bool ColumnarWriter::Write(const std::string& filename, std::string& error) const
+{
+    ColumnarHeader header;
+    header.columnCount = static_cast<unsigned int>(mColumns.size());
+
+    std::vector<ColumnDescriptor> descriptors(mColumns.size());
+    std::uint64_t offset = sizeof(header) + sizeof(ColumnDescriptor) * descriptors.size();
+    for (std::size_t i = 0; i < mColumns.size(); ++i)
+    {
+        const Column& column = mColumns[i];
+        if (column.name.size() >= COLUMN_NAME_SIZE)
+        {
+            error = "column name too long: " + column.name;
+            return false;
+        }
+        ColumnDescriptor& descriptor = descriptors[i];
+        std::memcpy(descriptor.name, column.name.c_str(), column.name.size());
+        descriptor.type = column.type;
+        descriptor.elementSize = column.elementSize;
+        descriptor.rowCount = column.rowCount;
+        descriptor.offset = AlignOffset(offset);
+        offset = descriptor.offset + column.data.size();
+    }
+
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+    {
+        error = "cannot create " + filename;
+        return false;
+    }
+
+    static const char padding[COLUMN_ALIGNMENT] = {};
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+              && std::fwrite(descriptors.data(), sizeof(ColumnDescriptor), descriptors.size(), file)
+                 == descriptors.size();
+    std::uint64_t position = sizeof(header) + sizeof(ColumnDescriptor) * descriptors.size();
+    for (std::size_t i = 0; ok && i < mColumns.size(); ++i)
+    {
+        const std::uint64_t gap = descriptors[i].offset - position;
+        ok = std::fwrite(padding, 1, gap, file) == gap
+             && std::fwrite(mColumns[i].data.data(), 1, mColumns[i].data.size(), file) == mColumns[i].data.size();
+        position = descriptors[i].offset + mColumns[i].data.size();
+    }
+
+    if (std::fclose(file) != 0 || !ok)
+    {
+        error = "cannot write to " + filename;
+        return false;
+    }
+    return true;
+}
+
+ColumnarFile::~ColumnarFile()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<char*>(mData), mSize);
+    }
+}
+
+bool ColumnarFile::Open(const std::string& filename, std::string& error)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(ColumnarHeader))
+    {
+        close(fd);
+        error = filename + " is not a columnar file";
+        return false;
+    }
+
+    mSize = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        error = "cannot map " + filename;
+        return false;
+    }
+    mData = static_cast<const char*>(data);
+
+    ColumnarHeader header;
+    std::memcpy(&header, mData, sizeof(header));
+    if (header.magic != COLUMNAR_MAGIC || header.version != COLUMNAR_VERSION
+        || sizeof(header) + sizeof(ColumnDescriptor) * header.columnCount > mSize)
+    {
+        error = filename + " is not a version " + std::to_string(COLUMNAR_VERSION) + " columnar file";
+        return false;
+    }
+
+    mColumns.resize(header.columnCount);
+    std::memcpy(mColumns.data(), mData + sizeof(header), sizeof(ColumnDescriptor) * header.columnCount);
+    for (const ColumnDescriptor& column : mColumns)
+    {
+        if (column.offset + column.rowCount * column.elementSize > mSize)
+        {
+            error = filename + " is truncated";
+            mColumns.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+const ColumnDescriptor* ColumnarFile::Find(const std::string& name) const
+{
+    for (const ColumnDescriptor& column : mColumns)
+    {
+        if (name.compare(0, std::string::npos, column.name, strnlen(column.name, COLUMN_NAME_SIZE)) == 0)
+        {
+            return &column;
+        }
+    }
+    return nullptr;
+}
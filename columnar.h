@@ -0,0 +1,140 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_COLUMNAR_H
+#define CPPREADY_TRADER_GO_COLUMNAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr unsigned int COLUMNAR_MAGIC = 0x43475452; // "RTGC"
+constexpr unsigned int COLUMNAR_VERSION = 1;
+constexpr std::size_t COLUMN_NAME_SIZE = 48;
+constexpr std::size_t COLUMN_ALIGNMENT = 64;
+
+enum class ColumnType : unsigned int
+{
+    UINT8,
+    UINT32,
+    INT64,
+    UINT64,
+    FLOAT32,
+    FLOAT64
+};
+
+template<typename T> struct ColumnTypeOf;
+template<> struct ColumnTypeOf<std::uint8_t> { static constexpr ColumnType value = ColumnType::UINT8; };
+template<> struct ColumnTypeOf<std::uint32_t> { static constexpr ColumnType value = ColumnType::UINT32; };
+template<> struct ColumnTypeOf<std::int64_t> { static constexpr ColumnType value = ColumnType::INT64; };
+template<> struct ColumnTypeOf<std::uint64_t> { static constexpr ColumnType value = ColumnType::UINT64; };
+template<> struct ColumnTypeOf<float> { static constexpr ColumnType value = ColumnType::FLOAT32; };
+template<> struct ColumnTypeOf<double> { static constexpr ColumnType value = ColumnType::FLOAT64; };
+
+// Columnar files hold a small header, a directory of named columns and then
+// each column as one contiguous, 64-byte aligned array. Columns may have
+// different lengths, so one file can hold several tables (for example one
+// per instrument) distinguished by column name prefix.
+struct ColumnarHeader
+{
+    unsigned int magic = COLUMNAR_MAGIC;
+    unsigned int version = COLUMNAR_VERSION;
+    unsigned int columnCount = 0;
+    unsigned int reserved = 0;
+};
+
+struct ColumnDescriptor
+{
+    char name[COLUMN_NAME_SIZE] = {};
+    ColumnType type = ColumnType::UINT8;
+    unsigned int elementSize = 0;
+    std::uint64_t rowCount = 0;
+    std::uint64_t offset = 0;
+};
+
+// Collects columns in memory and writes them out in one go.
+class ColumnarWriter
+{
+public:
+    template<typename T>
+    void AddColumn(const std::string& name, const std::vector<T>& values)
+    {
+        Column column;
+        column.name = name;
+        column.type = ColumnTypeOf<T>::value;
+        column.elementSize = sizeof(T);
+        column.rowCount = values.size();
+        column.data.assign(reinterpret_cast<const char*>(values.data()),
+                           reinterpret_cast<const char*>(values.data() + values.size()));
+        mColumns.push_back(std::move(column));
+    }
+
+    bool Write(const std::string& filename, std::string& error) const;
+
+private:
+    struct Column
+    {
+        std::string name;
+        ColumnType type;
+        unsigned int elementSize;
+        std::uint64_t rowCount;
+        std::vector<char> data;
+    };
+
+    std::vector<Column> mColumns;
+};
+
+// Read-only memory mapping of a columnar file. Column pointers remain valid
+// for the lifetime of the ColumnarFile.
+class ColumnarFile
+{
+public:
+    ColumnarFile() = default;
+    ~ColumnarFile();
+
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    bool Open(const std::string& filename, std::string& error);
+
+    const std::vector<ColumnDescriptor>& Columns() const { return mColumns; }
+
+    // Returns the named column if it exists and has element type T,
+    // otherwise null. rowCount receives the column length.
+    template<typename T>
+    const T* Column(const std::string& name, std::size_t& rowCount) const
+    {
+        const ColumnDescriptor* column = Find(name);
+        if (column == nullptr || column->type != ColumnTypeOf<T>::value)
+        {
+            rowCount = 0;
+            return nullptr;
+        }
+        rowCount = column->rowCount;
+        return reinterpret_cast<const T*>(mData + column->offset);
+    }
+
+private:
+    const ColumnDescriptor* Find(const std::string& name) const;
+
+    const char* mData = nullptr;
+    std::size_t mSize = 0;
+    std::vector<ColumnDescriptor> mColumns;
+};
+
+#endif //CPPREADY_TRADER_GO_COLUMNAR_H
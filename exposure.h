@@ -0,0 +1,169 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_EXPOSURE_H
+#define CPPREADY_TRADER_GO_EXPOSURE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+// Our exposure as the exchange sees it and as it could yet become: the ETF
+// and future positions, ETF order volume that could still fill, and hedge
+// volume awaiting its outcome. Every insert and hedge is sized against it
+// before it is sent, so that neither position limit can reject it.
+class ExposureModel
+{
+public:
+    ExposureModel(signed long positionLimit, signed long unhedgedLimit)
+        : mPositionLimit(positionLimit), mUnhedgedLimit(unhedgedLimit)
+    {
+    }
+
+    // The largest ETF order on a side that keeps the ETF position within
+    // its limit if it and every other order on that side filled, and the
+    // future position within its limit once all of that was hedged. Zero
+    // when residual delta already stands at the unhedged limit in the
+    // order's direction.
+    unsigned long InsertHeadroom(ReadyTraderGo::Side side) const noexcept
+    {
+        const signed long sign = (side == ReadyTraderGo::Side::BUY) ? 1 : -1;
+        if (sign * ResidualDelta() >= mUnhedgedLimit)
+        {
+            return 0;
+        }
+        const signed long etf = sign * mETFPosition + mPendingOrders[Index(side)];
+        const signed long future = -sign * mFuturePosition + mPendingOrders[Index(side)]
+                                   + mPendingHedges[Index(Opposite(side))];
+        return Headroom(std::max(etf, future));
+    }
+
+    // The largest hedge on a side that keeps the worst case future position
+    // within its limit.
+    unsigned long HedgeHeadroom(ReadyTraderGo::Side side) const noexcept
+    {
+        const signed long sign = (side == ReadyTraderGo::Side::BUY) ? 1 : -1;
+        return Headroom(sign * mFuturePosition + mPendingHedges[Index(side)]);
+    }
+
+    void OrderInserted(ReadyTraderGo::Side side, unsigned long volume) noexcept
+    {
+        mPendingOrders[Index(side)] += static_cast<signed long>(volume);
+    }
+
+    // A fill moves the position; the order volume it used up is released
+    // separately.
+    void OrderFilled(ReadyTraderGo::Side side, unsigned long volume) noexcept
+    {
+        const auto lots = static_cast<signed long>(volume);
+        mETFPosition += (side == ReadyTraderGo::Side::BUY) ? lots : -lots;
+    }
+
+    // Order volume that can no longer fill, because it filled or because
+    // the order was cancelled, rejected or is no longer tracked.
+    void OrderReleased(ReadyTraderGo::Side side, unsigned long volume) noexcept
+    {
+        mPendingOrders[Index(side)] -= static_cast<signed long>(volume);
+    }
+
+    void HedgeSent(ReadyTraderGo::Side side, unsigned long volume) noexcept
+    {
+        mPendingHedges[Index(side)] += static_cast<signed long>(volume);
+    }
+
+    void HedgeCompleted(ReadyTraderGo::Side side, unsigned long sentVolume, unsigned long filledVolume) noexcept
+    {
+        const auto lots = static_cast<signed long>(filledVolume);
+        mPendingHedges[Index(side)] -= static_cast<signed long>(sentVolume);
+        mFuturePosition += (side == ReadyTraderGo::Side::BUY) ? lots : -lots;
+    }
+
+    signed long ETFPosition() const noexcept { return mETFPosition; }
+    signed long FuturePosition() const noexcept { return mFuturePosition; }
+    signed long NetDelta() const noexcept { return mETFPosition + mFuturePosition; }
+
+    // Net delta that will remain once every hedge in flight has filled.
+    signed long ResidualDelta() const noexcept
+    {
+        return NetDelta() + mPendingHedges[Index(ReadyTraderGo::Side::BUY)]
+               - mPendingHedges[Index(ReadyTraderGo::Side::SELL)];
+    }
+
+private:
+    static std::size_t Index(ReadyTraderGo::Side side) noexcept
+    {
+        return static_cast<std::size_t>(side);
+    }
+
+    static ReadyTraderGo::Side Opposite(ReadyTraderGo::Side side) noexcept
+    {
+        return (side == ReadyTraderGo::Side::BUY) ? ReadyTraderGo::Side::SELL : ReadyTraderGo::Side::BUY;
+    }
+
+    unsigned long Headroom(signed long worstCase) const noexcept
+    {
+        return static_cast<unsigned long>(std::max(0L, mPositionLimit - worstCase));
+    }
+
+    signed long mPositionLimit;
+    signed long mUnhedgedLimit;
+    signed long mETFPosition = 0;
+    signed long mFuturePosition = 0;
+    std::array<signed long, 2> mPendingOrders{};
+    std::array<signed long, 2> mPendingHedges{};
+};
+
+// The volume of one ETF order that could still fill, held against the
+// model for as long as the order is tracked and released with whatever is
+// left when tracking ends.
+class OrderExposure
+{
+public:
+    OrderExposure(ExposureModel& model, ReadyTraderGo::Side side, unsigned long volume) noexcept
+        : mModel(model), mSide(side), mRemaining(volume)
+    {
+        mModel.OrderInserted(mSide, mRemaining);
+    }
+
+    OrderExposure(const OrderExposure&) = delete;
+    OrderExposure& operator=(const OrderExposure&) = delete;
+
+    ~OrderExposure()
+    {
+        mModel.OrderReleased(mSide, mRemaining);
+    }
+
+    ReadyTraderGo::Side OrderSide() const noexcept { return mSide; }
+    unsigned long Remaining() const noexcept { return mRemaining; }
+
+    void Filled(unsigned long volume) noexcept
+    {
+        const unsigned long used = std::min(volume, mRemaining);
+        mRemaining -= used;
+        mModel.OrderReleased(mSide, used);
+        mModel.OrderFilled(mSide, volume);
+    }
+
+private:
+    ExposureModel& mModel;
+    ReadyTraderGo::Side mSide;
+    unsigned long mRemaining;
+};
+
+#endif //CPPREADY_TRADER_GO_EXPOSURE_H
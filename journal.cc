@@ -0,0 +1,353 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "backgroundthread.h"
+#include "journal.h"
+#include "sessionfile.h"
+
+using namespace ReadyTraderGo;
+
+constexpr std::size_t JOURNAL_FILE_BUFFER_SIZE = 1 << 20;
+constexpr std::chrono::milliseconds JOURNAL_IDLE_SLEEP{1};
+
+JournalFileWriter::~JournalFileWriter()
+{
+    Close();
+}
+
+bool JournalFileWriter::Open(const std::string& filename, std::string& error)
+{
+    Close();
+    mFile = std::fopen(filename.c_str(), "wb");
+    if (mFile == nullptr)
+    {
+        error = "cannot create " + filename;
+        return false;
+    }
+    std::setvbuf(mFile, nullptr, _IOFBF, JOURNAL_FILE_BUFFER_SIZE);
+
+    JournalHeader header;
+    if (std::fwrite(&header, sizeof(header), 1, mFile) != 1)
+    {
+        error = "cannot write to " + filename;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool JournalFileWriter::Append(const JournalRecord& record)
+{
+    return mFile != nullptr && std::fwrite(&record, sizeof(record), 1, mFile) == 1;
+}
+
+bool JournalFileWriter::Close()
+{
+    if (mFile == nullptr)
+    {
+        return true;
+    }
+    bool result = std::fclose(mFile) == 0;
+    mFile = nullptr;
+    return result;
+}
+
+bool ReadJournal(const std::string& filename, std::vector<JournalRecord>& records, std::string& error)
+{
+    records.clear();
+
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    JournalHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != JOURNAL_MAGIC)
+    {
+        std::fclose(file);
+        error = filename + " is not a journal";
+        return false;
+    }
+    if (header.version != JOURNAL_VERSION || header.recordSize != sizeof(JournalRecord))
+    {
+        std::fclose(file);
+        error = filename + " has journal version " + std::to_string(header.version) + ", expected "
+                + std::to_string(JOURNAL_VERSION);
+        return false;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (!ec && size > sizeof(header))
+    {
+        records.resize((size - sizeof(header)) / sizeof(JournalRecord));
+    }
+    const std::size_t count = std::fread(records.data(), sizeof(JournalRecord), records.size(), file);
+    records.resize(count);
+    std::fclose(file);
+    return true;
+}
+
+std::vector<std::string> ListJournals(const std::string& directory)
+{
+    std::vector<std::string> result;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == JOURNAL_EXTENSION)
+        {
+            result.push_back(entry.path().string());
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+JournalRecorder::JournalRecorder(std::FILE* file) : mFile(file), mThread(&JournalRecorder::Run, this)
+{
+}
+
+JournalRecorder::~JournalRecorder()
+{
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    std::fclose(mFile);
+}
+
+std::unique_ptr<JournalRecorder> JournalRecorder::Create(const std::string& directory,
+                                                         const std::string& session,
+                                                         std::string& error)
+{
+    std::string filename;
+    std::FILE* file = CreateSessionFile(directory, session, JOURNAL_EXTENSION, filename, error);
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, JOURNAL_FILE_BUFFER_SIZE);
+
+    JournalHeader header;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        std::fclose(file);
+        error = "cannot write to " + filename;
+        return nullptr;
+    }
+    return std::make_unique<JournalRecorder>(file);
+}
+
+void JournalRecorder::Push(JournalRecordType type, JournalRecord& record) noexcept
+{
+    record.type = type;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (!mRing.TryPush(record))
+    {
+        mDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void JournalRecorder::OrderBook(Instrument instrument,
+                                unsigned long sequenceNumber,
+                                const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+{
+    JournalRecord record;
+    record.instrument = instrument;
+    record.sequenceNumber = sequenceNumber;
+    record.askPrices = askPrices;
+    record.askVolumes = askVolumes;
+    record.bidPrices = bidPrices;
+    record.bidVolumes = bidVolumes;
+    Push(JournalRecordType::ORDER_BOOK, record);
+}
+
+void JournalRecorder::TradeTicks(Instrument instrument,
+                                 unsigned long sequenceNumber,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                 const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes)
+{
+    JournalRecord record;
+    record.instrument = instrument;
+    record.sequenceNumber = sequenceNumber;
+    record.askPrices = askPrices;
+    record.askVolumes = askVolumes;
+    record.bidPrices = bidPrices;
+    record.bidVolumes = bidVolumes;
+    Push(JournalRecordType::TRADE_TICKS, record);
+}
+
+void JournalRecorder::OrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    JournalRecord record;
+    record.clientOrderId = clientOrderId;
+    record.price = price;
+    record.volume = volume;
+    Push(JournalRecordType::ORDER_FILLED, record);
+}
+
+void JournalRecorder::OrderStatus(unsigned long clientOrderId,
+                                  unsigned long fillVolume,
+                                  unsigned long remainingVolume,
+                                  signed long fees)
+{
+    JournalRecord record;
+    record.clientOrderId = clientOrderId;
+    record.volume = fillVolume;
+    record.remainingVolume = remainingVolume;
+    record.fees = fees;
+    Push(JournalRecordType::ORDER_STATUS, record);
+}
+
+void JournalRecorder::HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    JournalRecord record;
+    record.instrument = Instrument::FUTURE;
+    record.clientOrderId = clientOrderId;
+    record.price = price;
+    record.volume = volume;
+    Push(JournalRecordType::HEDGE_FILLED, record);
+}
+
+void JournalRecorder::Error(unsigned long clientOrderId)
+{
+    JournalRecord record;
+    record.clientOrderId = clientOrderId;
+    Push(JournalRecordType::ERROR, record);
+}
+
+void JournalRecorder::Disconnect()
+{
+    JournalRecord record;
+    Push(JournalRecordType::DISCONNECT, record);
+}
+
+void JournalRecorder::InsertOrder(unsigned long clientOrderId,
+                                  Side side,
+                                  unsigned long price,
+                                  unsigned long volume,
+                                  Lifespan lifespan)
+{
+    JournalRecord record;
+    record.clientOrderId = clientOrderId;
+    record.side = side;
+    record.price = price;
+    record.volume = volume;
+    record.lifespan = lifespan;
+    Push(JournalRecordType::INSERT_ORDER, record);
+}
+
+void JournalRecorder::CancelOrder(unsigned long clientOrderId)
+{
+    JournalRecord record;
+    record.clientOrderId = clientOrderId;
+    Push(JournalRecordType::CANCEL_ORDER, record);
+}
+
+void JournalRecorder::HedgeOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+{
+    JournalRecord record;
+    record.instrument = Instrument::FUTURE;
+    record.clientOrderId = clientOrderId;
+    record.side = side;
+    record.price = price;
+    record.volume = volume;
+    Push(JournalRecordType::HEDGE_ORDER, record);
+}
+
+void JournalRecorder::Opportunity(Side side,
+                                  unsigned long reason,
+                                  unsigned long edge,
+                                  unsigned long size,
+                                  unsigned long evaluations,
+                                  std::chrono::nanoseconds duration)
+{
+    JournalRecord record;
+    record.side = side;
+    record.clientOrderId = reason;
+    record.price = edge;
+    record.volume = size;
+    record.sequenceNumber = evaluations;
+    record.remainingVolume = static_cast<unsigned long>(duration.count());
+    Push(JournalRecordType::OPPORTUNITY, record);
+}
+
+void JournalRecorder::RoundTrip(unsigned long orderId,
+                                unsigned long hedgeId,
+                                Side side,
+                                unsigned long price,
+                                unsigned long volume,
+                                unsigned long referencePrice,
+                                unsigned long hedgePrice,
+                                unsigned long hedgeVolume,
+                                std::chrono::nanoseconds timeToHedge)
+{
+    JournalRecord record;
+    record.clientOrderId = orderId;
+    record.sequenceNumber = hedgeId;
+    record.side = side;
+    record.price = price;
+    record.volume = volume;
+    record.askPrices[0] = hedgePrice;
+    record.askVolumes[0] = hedgeVolume;
+    record.bidPrices[0] = referencePrice;
+    record.remainingVolume = static_cast<unsigned long>(std::max(timeToHedge.count(), 0L));
+    Push(JournalRecordType::ROUND_TRIP, record);
+}
+
+void JournalRecorder::Run()
+{
+    LowerThreadPriority();
+    JournalRecord record;
+    for (;;)
+    {
+        bool written = false;
+        while (mRing.TryPop(record))
+        {
+            std::fwrite(&record, sizeof(record), 1, mFile);
+            written = true;
+        }
+
+        if (!mRunning.load(std::memory_order_acquire) && mRing.Size() == 0)
+        {
+            break;
+        }
+
+        if (written)
+        {
+            std::fflush(mFile);
+        }
+        else
+        {
+            std::this_thread::sleep_for(JOURNAL_IDLE_SLEEP);
+        }
+    }
+}
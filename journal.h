@@ -0,0 +1,214 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_JOURNAL_H
+#define CPPREADY_TRADER_GO_JOURNAL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+#include "spscring.h"
+
+constexpr unsigned int JOURNAL_MAGIC = 0x4a475452; // "RTGJ"
+constexpr unsigned int JOURNAL_VERSION = 1;
+constexpr std::size_t JOURNAL_RING_CAPACITY = 8192;
+constexpr char JOURNAL_EXTENSION[] = ".rtgj";
+
+enum class JournalRecordType : unsigned char
+{
+    // Messages received by the AutoTrader.
+    ORDER_BOOK,
+    TRADE_TICKS,
+    ORDER_FILLED,
+    ORDER_STATUS,
+    HEDGE_FILLED,
+    ERROR,
+    DISCONNECT,
+
+    // Messages sent by the AutoTrader.
+    INSERT_ORDER,
+    CANCEL_ORDER,
+    HEDGE_ORDER,
+
+    // Annotations written by the AutoTrader.
+    OPPORTUNITY,
+    ROUND_TRIP
+};
+
+// One fixed-size journal entry. Fixed-size records keep the file seekable
+// by event index and let readers map it straight into an array.
+//
+// Field use by type:
+//   ORDER_BOOK, TRADE_TICKS: instrument, sequenceNumber and the level arrays
+//   ORDER_FILLED, HEDGE_FILLED: clientOrderId, price, volume
+//   ORDER_STATUS: clientOrderId, volume (fill volume), remainingVolume, fees
+//   ERROR: clientOrderId (the message text is not journaled)
+//   INSERT_ORDER: clientOrderId, side, price, volume, lifespan
+//   CANCEL_ORDER: clientOrderId
+//   HEDGE_ORDER: clientOrderId, side, price, volume
+//   OPPORTUNITY: side, clientOrderId (MissReason code), price (best edge in
+//                cents per lot), volume (largest size), sequenceNumber
+//                (evaluations), remainingVolume (duration in nanoseconds);
+//                written when the opportunity ends
+//   ROUND_TRIP: clientOrderId (ETF order), sequenceNumber (hedge order, zero
+//               if withheld), side, price and volume (ETF fill), askPrices[0]
+//               and askVolumes[0] (hedge fill), bidPrices[0] (the hedge's
+//               reference price), remainingVolume (time to hedge in
+//               nanoseconds); written when the hedge completes
+struct JournalRecord
+{
+    JournalRecordType type = JournalRecordType::ORDER_BOOK;
+    ReadyTraderGo::Instrument instrument = ReadyTraderGo::Instrument::ETF;
+    ReadyTraderGo::Side side = ReadyTraderGo::Side::BUY;
+    ReadyTraderGo::Lifespan lifespan = ReadyTraderGo::Lifespan::GOOD_FOR_DAY;
+    unsigned int reserved = 0;
+    signed long timestamp = 0; // nanoseconds, monotonic within a journal
+    unsigned long sequenceNumber = 0;
+    unsigned long clientOrderId = 0;
+    unsigned long price = 0;
+    unsigned long volume = 0;
+    unsigned long remainingVolume = 0;
+    signed long fees = 0;
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> askPrices{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> askVolumes{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> bidPrices{};
+    std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT> bidVolumes{};
+};
+
+static_assert(std::is_trivially_copyable<JournalRecord>::value, "journal records are written as raw bytes");
+
+struct JournalHeader
+{
+    unsigned int magic = JOURNAL_MAGIC;
+    unsigned int version = JOURNAL_VERSION;
+    unsigned int recordSize = sizeof(JournalRecord);
+    unsigned int reserved = 0;
+};
+
+// Synchronous, buffered journal file writer for offline tools.
+class JournalFileWriter
+{
+public:
+    JournalFileWriter() = default;
+    ~JournalFileWriter();
+
+    JournalFileWriter(const JournalFileWriter&) = delete;
+    JournalFileWriter& operator=(const JournalFileWriter&) = delete;
+
+    bool Open(const std::string& filename, std::string& error);
+    bool Append(const JournalRecord& record);
+    bool Close();
+
+private:
+    std::FILE* mFile = nullptr;
+};
+
+// Read a whole journal into memory. Returns false and describes the problem
+// in error if the file is missing or malformed.
+bool ReadJournal(const std::string& filename, std::vector<JournalRecord>& records, std::string& error);
+
+// List the journal files in a directory, sorted by name.
+std::vector<std::string> ListJournals(const std::string& directory);
+
+// Records the AutoTrader's inbound and outbound messages to a journal file.
+//
+// As with Analytics, the io_context thread only copies records into a
+// lock-free ring and a low-priority background thread does the file I/O.
+// Records are dropped and counted if the ring is full.
+class JournalRecorder
+{
+public:
+    explicit JournalRecorder(std::FILE* file);
+    ~JournalRecorder();
+
+    JournalRecorder(const JournalRecorder&) = delete;
+    JournalRecorder& operator=(const JournalRecorder&) = delete;
+
+    // Create a recorder writing to a new journal named for the session, see
+    // NewSessionName, in the given directory. Returns null if the directory
+    // does not exist or the file already does.
+    static std::unique_ptr<JournalRecorder> Create(const std::string& directory,
+                                                   const std::string& session,
+                                                   std::string& error);
+
+    // Producer side: must only be called from the io_context thread.
+    void OrderBook(ReadyTraderGo::Instrument instrument,
+                   unsigned long sequenceNumber,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
+    void TradeTicks(ReadyTraderGo::Instrument instrument,
+                    unsigned long sequenceNumber,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes);
+    void OrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume);
+    void OrderStatus(unsigned long clientOrderId,
+                     unsigned long fillVolume,
+                     unsigned long remainingVolume,
+                     signed long fees);
+    void HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume);
+    void Error(unsigned long clientOrderId);
+    void Disconnect();
+    void InsertOrder(unsigned long clientOrderId,
+                     ReadyTraderGo::Side side,
+                     unsigned long price,
+                     unsigned long volume,
+                     ReadyTraderGo::Lifespan lifespan);
+    void CancelOrder(unsigned long clientOrderId);
+    void HedgeOrder(unsigned long clientOrderId, ReadyTraderGo::Side side, unsigned long price, unsigned long volume);
+    void Opportunity(ReadyTraderGo::Side side,
+                     unsigned long reason,
+                     unsigned long edge,
+                     unsigned long size,
+                     unsigned long evaluations,
+                     std::chrono::nanoseconds duration);
+    void RoundTrip(unsigned long orderId,
+                   unsigned long hedgeId,
+                   ReadyTraderGo::Side side,
+                   unsigned long price,
+                   unsigned long volume,
+                   unsigned long referencePrice,
+                   unsigned long hedgePrice,
+                   unsigned long hedgeVolume,
+                   std::chrono::nanoseconds timeToHedge);
+
+    unsigned long DroppedRecords() const { return mDroppedRecords.load(std::memory_order_relaxed); }
+
+private:
+    void Push(JournalRecordType type, JournalRecord& record) noexcept;
+    void Run();
+
+    std::FILE* mFile;
+    SPSCRing<JournalRecord, JOURNAL_RING_CAPACITY> mRing;
+    std::atomic<bool> mRunning{true};
+    std::atomic<unsigned long> mDroppedRecords{0};
+    std::thread mThread;
+};
+
+#endif //CPPREADY_TRADER_GO_JOURNAL_H
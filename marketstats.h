@@ -0,0 +1,103 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_MARKETSTATS_H
+#define CPPREADY_TRADER_GO_MARKETSTATS_H
+
+#include <array>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+#include "quantilesketch.h"
+
+enum class MarketStat : unsigned char
+{
+    ETF_SPREAD,    // touch spread on each ETF book, in cents
+    FUTURE_SPREAD, // touch spread on each future book, in cents
+    BASIS,         // ETF mid less future mid on each book, in cents
+    FILL_EDGE,     // per lot against the future mid, in our favour, weighted by volume
+    FILL_SIZE      // lots per ETF fill
+};
+
+constexpr std::size_t MARKET_STAT_COUNT = 5;
+
+constexpr const char* MarketStatName(MarketStat stat) noexcept
+{
+    constexpr std::array<const char*, MARKET_STAT_COUNT> NAMES = {
+            "etf_spread", "future_spread", "basis", "fill_edge", "fill_size"};
+    return NAMES[static_cast<std::size_t>(stat)];
+}
+
+// Streaming quantiles of the market statistics taken from order books and
+// fills, in fixed memory for any session length. Stats from several
+// threads or sessions combine with Merge.
+class MarketStats
+{
+public:
+    void OrderBook(ReadyTraderGo::Instrument instrument, unsigned long askPrice, unsigned long bidPrice) noexcept
+    {
+        if (askPrice == 0 || bidPrice == 0)
+        {
+            return;
+        }
+        const bool etf = instrument == ReadyTraderGo::Instrument::ETF;
+        const double spread = static_cast<double>(askPrice) - static_cast<double>(bidPrice);
+        mSketches[static_cast<std::size_t>(etf ? MarketStat::ETF_SPREAD : MarketStat::FUTURE_SPREAD)].Add(spread);
+        (etf ? mETFMid : mFutureMid) = (static_cast<double>(askPrice) + static_cast<double>(bidPrice)) / 2;
+        if (mETFMid != 0.0 && mFutureMid != 0.0)
+        {
+            mSketches[static_cast<std::size_t>(MarketStat::BASIS)].Add(mETFMid - mFutureMid);
+        }
+    }
+
+    void Filled(ReadyTraderGo::Side side, unsigned long price, unsigned long volume) noexcept
+    {
+        if (volume == 0)
+        {
+            return;
+        }
+        const auto lots = static_cast<double>(volume);
+        mSketches[static_cast<std::size_t>(MarketStat::FILL_SIZE)].Add(lots);
+        if (mFutureMid != 0.0)
+        {
+            const double edge = mFutureMid - static_cast<double>(price);
+            mSketches[static_cast<std::size_t>(MarketStat::FILL_EDGE)]
+                    .Add((side == ReadyTraderGo::Side::BUY) ? edge : -edge, lots);
+        }
+    }
+
+    void Merge(const MarketStats& other) noexcept
+    {
+        for (std::size_t i = 0; i < MARKET_STAT_COUNT; ++i)
+        {
+            mSketches[i].Merge(other.mSketches[i]);
+        }
+    }
+
+    QuantileSketch& operator[](MarketStat stat) noexcept
+    {
+        return mSketches[static_cast<std::size_t>(stat)];
+    }
+
+private:
+    std::array<QuantileSketch, MARKET_STAT_COUNT> mSketches;
+    double mETFMid = 0.0;
+    double mFutureMid = 0.0;
+};
+
+#endif //CPPREADY_TRADER_GO_MARKETSTATS_H
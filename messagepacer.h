@@ -0,0 +1,146 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_MESSAGEPACER_H
+#define CPPREADY_TRADER_GO_MESSAGEPACER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+// The exchange's limit on messages sent within any rolling window.
+constexpr std::size_t MESSAGE_LIMIT = 50;
+constexpr std::chrono::nanoseconds MESSAGE_WINDOW = std::chrono::seconds(1);
+
+// Messages held back for hedges and protective cancels, which are always
+// sent: quotes may not use the last HEDGE_RESERVE of the budget.
+constexpr std::size_t HEDGE_RESERVE = 10;
+
+// While at least FREE_BUDGET messages would remain after a quote, it goes
+// out whatever it is worth. Below that, every message of budget it would
+// leave short of FREE_BUDGET raises the value, in cents of edge times lots,
+// that the quote must carry by QUOTE_VALUE_PER_MESSAGE.
+constexpr std::size_t FREE_BUDGET = 25;
+constexpr signed long QUOTE_VALUE_PER_MESSAGE = 200;
+
+// A side's re-quote: the messages it needs and what it is worth.
+struct PacedQuote
+{
+    std::size_t messages = 0;
+    signed long value = 0;
+};
+
+// A side's re-quote as the quote kernel decided it: a cancel, an insert of
+// the volume the exposure model allows, or both, worth the insert's edge
+// per lot times its volume.
+inline PacedQuote PaceQuote(signed long cancel, signed long insert, unsigned long volume, signed long edge) noexcept
+{
+    const bool inserts = insert != 0 && volume != 0;
+    return {static_cast<std::size_t>(cancel) + (inserts ? 1 : 0),
+            inserts ? edge * static_cast<signed long>(volume) : 0};
+}
+
+struct PacingDecision
+{
+    bool ask = true;
+    bool bid = true;
+};
+
+// Spends the message budget where it earns the most. Every send is
+// recorded; hedges and protective cancels are never held back, while
+// quotes are admitted by value against what is left of the budget, the
+// more valuable side first, so that a marginal re-quote cannot use up
+// messages a large opportunity later in the window will need.
+class MessagePacer
+{
+public:
+    void Sent(std::chrono::nanoseconds now) noexcept
+    {
+        Expire(now);
+        if (mCount == mTimes.size())
+        {
+            mHead = (mHead + 1) % mTimes.size();
+            --mCount;
+        }
+        mTimes[(mHead + mCount) % mTimes.size()] = now;
+        ++mCount;
+    }
+
+    // Messages that can still be sent in the current window.
+    std::size_t Remaining(std::chrono::nanoseconds now) noexcept
+    {
+        Expire(now);
+        return (mCount < MESSAGE_LIMIT) ? MESSAGE_LIMIT - mCount : 0;
+    }
+
+    PacingDecision Admit(std::chrono::nanoseconds now, const PacedQuote& ask, const PacedQuote& bid) noexcept
+    {
+        std::size_t remaining = Remaining(now);
+        PacingDecision decision;
+        const bool askFirst = ask.value >= bid.value;
+        bool& first = askFirst ? decision.ask : decision.bid;
+        bool& second = askFirst ? decision.bid : decision.ask;
+        first = Admit(askFirst ? ask : bid, remaining);
+        second = Admit(askFirst ? bid : ask, remaining);
+        return decision;
+    }
+
+    unsigned long Deferrals() const noexcept { return mDeferrals; }
+
+private:
+    void Expire(std::chrono::nanoseconds now) noexcept
+    {
+        while (mCount != 0 && mTimes[mHead] <= now - MESSAGE_WINDOW)
+        {
+            mHead = (mHead + 1) % mTimes.size();
+            --mCount;
+        }
+    }
+
+    bool Admit(const PacedQuote& quote, std::size_t& remaining) noexcept
+    {
+        if (quote.messages == 0)
+        {
+            return true;
+        }
+        if (remaining < quote.messages + HEDGE_RESERVE)
+        {
+            ++mDeferrals;
+            return false;
+        }
+        const std::size_t left = remaining - quote.messages;
+        const signed long threshold = (left >= FREE_BUDGET)
+                                      ? 0
+                                      : QUOTE_VALUE_PER_MESSAGE * static_cast<signed long>(FREE_BUDGET - left);
+        if (quote.value < threshold)
+        {
+            ++mDeferrals;
+            return false;
+        }
+        remaining = left;
+        return true;
+    }
+
+    // Send times within the window, oldest first, in a ring with room for
+    // the sends the budget allows plus any forced past it.
+    std::array<std::chrono::nanoseconds, 2 * MESSAGE_LIMIT> mTimes{};
+    std::size_t mHead = 0;
+    std::size_t mCount = 0;
+    unsigned long mDeferrals = 0;
+};
+
+#endif //CPPREADY_TRADER_GO_MESSAGEPACER_H
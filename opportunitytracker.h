@@ -0,0 +1,136 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_OPPORTUNITYTRACKER_H
+#define CPPREADY_TRADER_GO_OPPORTUNITYTRACKER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+// Why a detected ETF/future cross was not acted on, or TAKEN if an order
+// was sent for it. Codes are journaled, so only ever append.
+enum class MissReason : unsigned char
+{
+    TAKEN,
+    POSITION_LIMIT,  // the quote kernel's position limit
+    EXPOSURE_LIMIT,  // no headroom left in the exposure model
+    ORDER_IN_FLIGHT, // our order from before the cross is still working at that price
+    MESSAGE_BUDGET   // deferred by the message pacer
+};
+
+constexpr std::size_t MISS_REASON_COUNT = 5;
+
+constexpr const char* MissReasonName(MissReason reason) noexcept
+{
+    constexpr std::array<const char*, MISS_REASON_COUNT> NAMES = {
+            "taken", "position_limit", "exposure_limit", "order_in_flight", "message_budget"};
+    return NAMES[static_cast<std::size_t>(reason)];
+}
+
+// One cross on one side, from the first evaluation that saw it to the
+// first that did not.
+struct Opportunity
+{
+    ReadyTraderGo::Side side = ReadyTraderGo::Side::BUY;
+    MissReason reason = MissReason::TAKEN;
+    unsigned long size = 0;        // largest volume the quote kernel wanted, in lots
+    signed long edge = 0;          // best edge seen, in cents per lot
+    unsigned long evaluations = 0; // quote evaluations that saw it
+    std::chrono::nanoseconds start{0};
+    std::chrono::nanoseconds duration{0};
+};
+
+// Follows the cross on each side across quote evaluations. An opportunity
+// counts as taken if any evaluation sent an order for it, and otherwise
+// takes the reason from the last evaluation that saw it. Finished
+// opportunities are counted by reason, with their size and the value,
+// edge times size, left on the table.
+class OpportunityTracker
+{
+public:
+    // Record one evaluation's view of a side. Returns true when this ends
+    // an opportunity on that side, which is then described by finished.
+    bool Observe(ReadyTraderGo::Side side,
+                 std::chrono::nanoseconds now,
+                 bool present,
+                 unsigned long size,
+                 signed long edge,
+                 MissReason reason,
+                 Opportunity& finished) noexcept
+    {
+        Opportunity& current = mCurrent[static_cast<std::size_t>(side)];
+        bool& open = mOpen[static_cast<std::size_t>(side)];
+        bool ended = false;
+        if (open && !present)
+        {
+            current.duration = now - current.start;
+            finished = current;
+            Count(current);
+            open = false;
+            ended = true;
+        }
+        if (!present)
+        {
+            return ended;
+        }
+
+        if (!open)
+        {
+            current = Opportunity{};
+            current.side = side;
+            current.start = now;
+            open = true;
+        }
+        current.size = std::max(current.size, size);
+        current.edge = std::max(current.edge, edge);
+        ++current.evaluations;
+        if (current.reason != MissReason::TAKEN || current.evaluations == 1)
+        {
+            current.reason = reason;
+        }
+        return ended;
+    }
+
+    unsigned long Count(MissReason reason) const noexcept { return mCounts[Index(reason)]; }
+    unsigned long Volume(MissReason reason) const noexcept { return mVolumes[Index(reason)]; }
+    signed long Value(MissReason reason) const noexcept { return mValues[Index(reason)]; }
+
+private:
+    static std::size_t Index(MissReason reason) noexcept
+    {
+        return static_cast<std::size_t>(reason);
+    }
+
+    void Count(const Opportunity& opportunity) noexcept
+    {
+        ++mCounts[Index(opportunity.reason)];
+        mVolumes[Index(opportunity.reason)] += opportunity.size;
+        mValues[Index(opportunity.reason)] += opportunity.edge * static_cast<signed long>(opportunity.size);
+    }
+
+    std::array<Opportunity, 2> mCurrent{};
+    std::array<bool, 2> mOpen{};
+    std::array<unsigned long, MISS_REASON_COUNT> mCounts{};
+    std::array<unsigned long, MISS_REASON_COUNT> mVolumes{};
+    std::array<signed long, MISS_REASON_COUNT> mValues{};
+};
+
+#endif //CPPREADY_TRADER_GO_OPPORTUNITYTRACKER_H
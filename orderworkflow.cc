@@ -0,0 +1,134 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "orderworkflow.h"
+
+WorkflowFramePool::~WorkflowFramePool()
+{
+    for (void* slab : mSlabs)
+    {
+        ::operator delete(slab);
+    }
+}
+
+WorkflowFramePool& WorkflowFramePool::Local()
+{
+    static thread_local WorkflowFramePool pool;
+    return pool;
+}
+
+void WorkflowFramePool::Grow()
+{
+    auto* slab = static_cast<unsigned char*>(::operator new(WORKFLOW_FRAME_SIZE * WORKFLOW_FRAMES_PER_SLAB));
+    mSlabs.push_back(slab);
+    for (std::size_t i = 0; i < WORKFLOW_FRAMES_PER_SLAB; ++i)
+    {
+        auto* frame = reinterpret_cast<FreeFrame*>(slab + i * WORKFLOW_FRAME_SIZE);
+        frame->next = mFree;
+        mFree = frame;
+    }
+}
+
+void* WorkflowFramePool::Allocate(std::size_t size)
+{
+    if (size > WORKFLOW_FRAME_SIZE)
+    {
+        ++mHeapFallbacks;
+        return ::operator new(size);
+    }
+    if (mFree == nullptr)
+    {
+        Grow();
+    }
+    FreeFrame* frame = mFree;
+    mFree = frame->next;
+    return frame;
+}
+
+void WorkflowFramePool::Deallocate(void* frame, std::size_t size) noexcept
+{
+    if (size > WORKFLOW_FRAME_SIZE)
+    {
+        ::operator delete(frame);
+        return;
+    }
+    auto* free = static_cast<FreeFrame*>(frame);
+    free->next = mFree;
+    mFree = free;
+}
+
+WorkflowDispatcher::~WorkflowDispatcher()
+{
+    for (Waiters* waiters : {&mOrders, &mHedges})
+    {
+        for (auto& [clientOrderId, waiter] : *waiters)
+        {
+            waiter.handle.destroy();
+        }
+        waiters->clear();
+    }
+}
+
+template<typename Result>
+bool WorkflowDispatcher::Resume(Waiters& waiters, unsigned long clientOrderId, const Result& result)
+{
+    auto it = waiters.find(clientOrderId);
+    if (it == waiters.end())
+    {
+        return false;
+    }
+
+    // The workflow registers itself again if it waits for another message.
+    const Waiter waiter = it->second;
+    waiters.erase(it);
+    *static_cast<Result*>(waiter.slot) = result;
+    waiter.handle.resume();
+    return true;
+}
+
+std::vector<std::pair<unsigned long, const void*>> WorkflowDispatcher::Waiting(const Waiters& waiters)
+{
+    std::vector<std::pair<unsigned long, const void*>> waiting;
+    waiting.reserve(waiters.size());
+    for (const auto& [clientOrderId, waiter] : waiters)
+    {
+        waiting.emplace_back(clientOrderId, waiter.state);
+    }
+    std::sort(waiting.begin(), waiting.end());
+    return waiting;
+}
+
+bool WorkflowDispatcher::OrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    return Resume(mOrders, clientOrderId, OrderEvent{OrderEvent::Type::FILLED, price, volume, 0});
+}
+
+bool WorkflowDispatcher::OrderStatus(unsigned long clientOrderId,
+                                     unsigned long fillVolume,
+                                     unsigned long remainingVolume)
+{
+    return Resume(mOrders, clientOrderId, OrderEvent{OrderEvent::Type::STATUS, 0, fillVolume, remainingVolume});
+}
+
+bool WorkflowDispatcher::HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume)
+{
+    return Resume(mHedges, clientOrderId, HedgeResult{price, volume});
+}
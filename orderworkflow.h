@@ -0,0 +1,212 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_ORDERWORKFLOW_H
+#define CPPREADY_TRADER_GO_ORDERWORKFLOW_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Order lifecycles written as C++20 coroutines.
+//
+// A workflow is a coroutine returning Workflow. It starts running as soon
+// as it is called, and each co_await on a WorkflowDispatcher suspends it
+// until the matching OrderStatus, OrderFilled or HedgeFilled message is
+// dispatched from the io_context thread, so the steps of an order read in
+// the order they happen instead of being spread across the handlers.
+// Everything runs on the io_context thread; nothing here is thread-safe.
+
+constexpr std::size_t WORKFLOW_FRAME_SIZE = 256;
+constexpr std::size_t WORKFLOW_FRAMES_PER_SLAB = 64;
+
+// Fixed-size blocks for coroutine frames, so that starting a workflow per
+// order does not allocate. Freed frames go onto a free list for reuse and
+// the pool grows a slab at a time. Frames larger than a block fall back to
+// the heap and are counted.
+class WorkflowFramePool
+{
+public:
+    WorkflowFramePool() = default;
+    ~WorkflowFramePool();
+
+    WorkflowFramePool(const WorkflowFramePool&) = delete;
+    WorkflowFramePool& operator=(const WorkflowFramePool&) = delete;
+
+    void* Allocate(std::size_t size);
+    void Deallocate(void* frame, std::size_t size) noexcept;
+
+    unsigned long HeapFallbacks() const { return mHeapFallbacks; }
+
+    // The pool used by every workflow frame on this thread.
+    static WorkflowFramePool& Local();
+
+private:
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    void Grow();
+
+    FreeFrame* mFree = nullptr;
+    std::vector<void*> mSlabs;
+    unsigned long mHeapFallbacks = 0;
+};
+
+// The coroutine type of a workflow. Workflows are detached: they run until
+// their first co_await, and their frame is released when they finish or
+// when the dispatcher abandons them.
+class Workflow
+{
+public:
+    struct promise_type
+    {
+        Workflow get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void* operator new(std::size_t size) { return WorkflowFramePool::Local().Allocate(size); }
+        static void operator delete(void* frame, std::size_t size) noexcept
+        {
+            WorkflowFramePool::Local().Deallocate(frame, size);
+        }
+    };
+};
+
+// A message about one of our ETF orders.
+struct OrderEvent
+{
+    enum class Type
+    {
+        FILLED,
+        STATUS
+    };
+
+    Type type = Type::STATUS;
+    unsigned long price = 0;
+    unsigned long volume = 0; // fill volume, or total filled volume for a status
+    unsigned long remainingVolume = 0;
+};
+
+// The outcome of a hedge order. Both fields are zero if it failed.
+struct HedgeResult
+{
+    unsigned long price = 0;
+    unsigned long volume = 0;
+};
+
+// Routes exchange messages to the workflows waiting for them, by client
+// order id.
+//
+// At most one workflow waits on an order id at a time; a workflow that
+// waits on an id already claimed by another takes it over, and the other is
+// abandoned. This matches the previous bookkeeping, where an order id was
+// routed to whichever side most recently registered it.
+class WorkflowDispatcher
+{
+    // Each waiting workflow, where to put the message that resumes it, and
+    // the state it registered, if any.
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;
+        void* slot;
+        const void* state;
+    };
+    using Waiters = std::unordered_map<unsigned long, Waiter>;
+
+public:
+    WorkflowDispatcher() = default;
+    ~WorkflowDispatcher();
+
+    WorkflowDispatcher(const WorkflowDispatcher&) = delete;
+    WorkflowDispatcher& operator=(const WorkflowDispatcher&) = delete;
+
+    template<typename Result>
+    class Awaiter
+    {
+    public:
+        Awaiter(Waiters& waiters, unsigned long clientOrderId, const void* state)
+            : mWaiters(waiters), mClientOrderId(clientOrderId), mState(state)
+        {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            auto [it, inserted] = mWaiters.try_emplace(mClientOrderId, Waiter{handle, &mResult, mState});
+            if (!inserted)
+            {
+                std::coroutine_handle<> abandoned = it->second.handle;
+                it->second = {handle, &mResult, mState};
+                abandoned.destroy();
+            }
+        }
+
+        Result await_resume() const noexcept { return mResult; }
+
+    private:
+        Waiters& mWaiters;
+        unsigned long mClientOrderId;
+        const void* mState;
+        Result mResult;
+    };
+
+    // Suspend until the next fill or status message for an order. The
+    // state, which must live in the workflow's frame, is what Waiting
+    // reports for it while it waits.
+    Awaiter<OrderEvent> NextOrderEvent(unsigned long clientOrderId, const void* state = nullptr)
+    {
+        return {mOrders, clientOrderId, state};
+    }
+
+    // Suspend until a hedge order is filled or fails.
+    Awaiter<HedgeResult> HedgeFilled(unsigned long clientOrderId, const void* state = nullptr)
+    {
+        return {mHedges, clientOrderId, state};
+    }
+
+    // True if a workflow is waiting on this order.
+    bool Contains(unsigned long clientOrderId) const { return mOrders.count(clientOrderId) != 0; }
+
+    // The order or hedge ids that workflows are waiting on, in id order,
+    // with the state each registered.
+    std::vector<std::pair<unsigned long, const void*>> WaitingOrders() const { return Waiting(mOrders); }
+    std::vector<std::pair<unsigned long, const void*>> WaitingHedges() const { return Waiting(mHedges); }
+
+    // Resume the workflow waiting on the order or hedge, if any. Returns
+    // false if there was none.
+    bool OrderFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume);
+    bool OrderStatus(unsigned long clientOrderId, unsigned long fillVolume, unsigned long remainingVolume);
+    bool HedgeFilled(unsigned long clientOrderId, unsigned long price, unsigned long volume);
+
+private:
+    template<typename Result>
+    static bool Resume(Waiters& waiters, unsigned long clientOrderId, const Result& result);
+    static std::vector<std::pair<unsigned long, const void*>> Waiting(const Waiters& waiters);
+
+    Waiters mOrders;
+    Waiters mHedges;
+};
+
+#endif //CPPREADY_TRADER_GO_ORDERWORKFLOW_H
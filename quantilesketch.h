@@ -0,0 +1,184 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_QUANTILESKETCH_H
+#define CPPREADY_TRADER_GO_QUANTILESKETCH_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+constexpr double QUANTILE_COMPRESSION = 200.0;
+constexpr double QUANTILE_PI = 3.14159265358979323846;
+constexpr std::size_t QUANTILE_CENTROIDS = 2 * static_cast<std::size_t>(QUANTILE_COMPRESSION);
+constexpr std::size_t QUANTILE_BUFFER = 3 * static_cast<std::size_t>(QUANTILE_COMPRESSION);
+
+// A merging t-digest: a streaming estimate of a distribution's quantiles in
+// fixed memory, however many values it has seen.
+//
+// Values are buffered and, when the buffer fills, merged with the existing
+// centroids in one sorted pass. A centroid may only grow while it spans at
+// most one unit of the arcsine scale function, which keeps centroids small
+// near the tails, so extreme quantiles stay accurate, and caps their number
+// at about the compression. Two sketches merge by adding one's centroids to
+// the other, so per-thread or per-session sketches can be combined.
+class QuantileSketch
+{
+public:
+    void Add(double value, double weight = 1.0) noexcept
+    {
+        if (mSize == mCentroids.size())
+        {
+            Compress();
+        }
+        mCentroids[mSize++] = {value, weight};
+        mMin = std::min(mMin, value);
+        mMax = std::max(mMax, value);
+    }
+
+    void Merge(const QuantileSketch& other) noexcept
+    {
+        for (std::size_t i = 0; i < other.mSize; ++i)
+        {
+            Add(other.mCentroids[i].mean, other.mCentroids[i].weight);
+        }
+        mMin = std::min(mMin, other.mMin);
+        mMax = std::max(mMax, other.mMax);
+    }
+
+    // The estimated value below which the given fraction of the weight
+    // lies, or zero if the sketch is empty. Folds in any buffered values
+    // first.
+    double Quantile(double fraction) noexcept
+    {
+        Compress();
+        if (mSize == 0)
+        {
+            return 0.0;
+        }
+        if (mSize == 1)
+        {
+            return mCentroids[0].mean;
+        }
+
+        // Each centroid's weight is taken to be spread evenly about its
+        // mean, with the extremes at the ends.
+        const double target = std::clamp(fraction, 0.0, 1.0) * mWeight;
+        const Centroid& first = mCentroids[0];
+        if (target < first.weight / 2)
+        {
+            return mMin + (first.mean - mMin) * target / (first.weight / 2);
+        }
+        double cumulative = first.weight / 2;
+        for (std::size_t i = 1; i < mSize; ++i)
+        {
+            const Centroid& left = mCentroids[i - 1];
+            const Centroid& right = mCentroids[i];
+            const double gap = (left.weight + right.weight) / 2;
+            if (target < cumulative + gap)
+            {
+                return left.mean + (right.mean - left.mean) * (target - cumulative) / gap;
+            }
+            cumulative += gap;
+        }
+        const Centroid& last = mCentroids[mSize - 1];
+        const double tail = std::max(mWeight - cumulative, std::numeric_limits<double>::min());
+        return last.mean + (mMax - last.mean) * std::min(1.0, (target - cumulative) / tail);
+    }
+
+    double Count() noexcept
+    {
+        Compress();
+        return mWeight;
+    }
+
+    void Clear() noexcept
+    {
+        mSize = 0;
+        mMerged = 0;
+        mWeight = 0.0;
+        mMin = std::numeric_limits<double>::infinity();
+        mMax = -std::numeric_limits<double>::infinity();
+    }
+
+private:
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    static double Scale(double q) noexcept
+    {
+        return QUANTILE_COMPRESSION / (2 * QUANTILE_PI) * std::asin(2 * q - 1);
+    }
+
+    static double InverseScale(double k) noexcept
+    {
+        const double angle = std::clamp(k * 2 * QUANTILE_PI / QUANTILE_COMPRESSION, -QUANTILE_PI / 2, QUANTILE_PI / 2);
+        return (std::sin(angle) + 1) / 2;
+    }
+
+    void Compress() noexcept
+    {
+        if (mSize == mMerged)
+        {
+            return;
+        }
+        std::sort(mCentroids.begin(), mCentroids.begin() + mSize,
+                  [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+        double total = 0.0;
+        for (std::size_t i = 0; i < mSize; ++i)
+        {
+            total += mCentroids[i].weight;
+        }
+
+        std::size_t out = 0;
+        double before = 0.0;
+        double limit = InverseScale(Scale(0.0) + 1) * total;
+        for (std::size_t i = 1; i < mSize; ++i)
+        {
+            Centroid& current = mCentroids[out];
+            const Centroid& next = mCentroids[i];
+            if (before + current.weight + next.weight <= limit)
+            {
+                current.mean += (next.mean - current.mean) * next.weight / (current.weight + next.weight);
+                current.weight += next.weight;
+            }
+            else
+            {
+                before += current.weight;
+                limit = InverseScale(Scale(before / total) + 1) * total;
+                mCentroids[++out] = next;
+            }
+        }
+        mSize = out + 1;
+        mMerged = mSize;
+        mWeight = total;
+    }
+
+    std::array<Centroid, QUANTILE_CENTROIDS + QUANTILE_BUFFER> mCentroids{};
+    std::size_t mSize = 0;   // centroids, merged ones first
+    std::size_t mMerged = 0; // of which are merged and sorted
+    double mWeight = 0.0;    // of the merged centroids
+    double mMin = std::numeric_limits<double>::infinity();
+    double mMax = -std::numeric_limits<double>::infinity();
+};
+
+#endif //CPPREADY_TRADER_GO_QUANTILESKETCH_H
@@ -0,0 +1,335 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_QUOTEKERNEL_H
+#define CPPREADY_TRADER_GO_QUOTEKERNEL_H
+
+#include <cstddef>
+#include <vector>
+
+// Tunable inputs to the quote decision.
+struct QuoteParameters
+{
+    // Amount, in cents, by which the (skewed) future price must cross the
+    // ETF price before we trade.
+    signed long minEdge = 0;
+    signed long positionLimit = 100;
+    signed long lotSize = 10;
+};
+
+// Market inputs to one evaluation. The future prices are the fair
+// reference prices after any signal skew and are zero when that side of
+// the future book is empty.
+struct QuoteInputs
+{
+    unsigned long etfAskPrice = 0;
+    unsigned long etfBidPrice = 0;
+    unsigned long futAskPrice = 0;
+    unsigned long futBidPrice = 0;
+    unsigned long futAskVolume = 0;
+    unsigned long futBidVolume = 0;
+    // Prices at which to place our buy and sell when the cross test wants
+    // them; zero means take the ETF touch.
+    unsigned long etfAskQuotePrice = 0;
+    unsigned long etfBidQuotePrice = 0;
+    bool etfUpdate = false; // true if triggered by an ETF book, false for the future book
+};
+
+// Our order state as seen by the decision: at most one buy ("ask") and one
+// sell ("bid") ETF order at a time. Flags are zero or one.
+struct QuoteState
+{
+    unsigned long askPrice = 0;
+    unsigned long bidPrice = 0;
+    signed long askLive = 0;
+    signed long bidLive = 0;
+    signed long position = 0;
+};
+
+// Flags are zero or one.
+struct QuoteDecision
+{
+    unsigned long newAskPrice = 0;
+    unsigned long newBidPrice = 0;
+    signed long askVolume = 0;
+    signed long bidVolume = 0;
+    signed long cancelAsk = 0;
+    signed long cancelBid = 0;
+    signed long insertAsk = 0;
+    signed long insertBid = 0;
+};
+
+// A threshold no real price crosses, used to disable a side.
+constexpr signed long NO_CROSS_THRESHOLD = 1L << 62;
+
+// The parts of the decision that depend only on the market, computed once
+// per event and shared by every parameter set.
+struct QuoteMarket
+{
+    unsigned long etfAskPrice = 0;
+    unsigned long etfBidPrice = 0;
+    signed long futAskPrice = 0;
+    signed long futBidPrice = 0;
+    signed long askThreshold = NO_CROSS_THRESHOLD;
+    signed long bidThreshold = -NO_CROSS_THRESHOLD;
+    signed long lotSizeWeight = 0;
+    signed long askBookVolume = 0;
+    signed long bidBookVolume = 0;
+};
+
+// Select rather than convert: GCC vectorises a select between constants but
+// not a bool to integer conversion.
+inline signed long QuoteFlag(bool condition) noexcept
+{
+    return condition ? 1 : 0;
+}
+
+// The presence check is made against the other instrument's book, and a
+// side whose check fails gets a threshold that can never be crossed. On a
+// future update orders are sized from the future's top level rather than
+// the lot size, exactly as the handler has always done.
+inline QuoteMarket PrepareQuoteMarket(const QuoteInputs& inputs) noexcept
+{
+    QuoteMarket market;
+    market.etfAskPrice = (inputs.etfAskQuotePrice != 0) ? inputs.etfAskQuotePrice : inputs.etfAskPrice;
+    market.etfBidPrice = (inputs.etfBidQuotePrice != 0) ? inputs.etfBidQuotePrice : inputs.etfBidPrice;
+    market.futAskPrice = static_cast<signed long>(inputs.futAskPrice);
+    market.futBidPrice = static_cast<signed long>(inputs.futBidPrice);
+
+    const bool askPresent = inputs.etfUpdate ? inputs.futBidPrice != 0 : inputs.etfAskPrice != 0;
+    const bool bidPresent = inputs.etfUpdate ? inputs.futAskPrice != 0 : inputs.etfBidPrice != 0;
+    market.askThreshold = askPresent ? static_cast<signed long>(inputs.etfAskPrice) : NO_CROSS_THRESHOLD;
+    market.bidThreshold = bidPresent ? static_cast<signed long>(inputs.etfBidPrice) : -NO_CROSS_THRESHOLD;
+
+    market.lotSizeWeight = inputs.etfUpdate ? 1 : 0;
+    market.askBookVolume = inputs.etfUpdate ? 0 : static_cast<signed long>(inputs.futAskVolume);
+    market.bidBookVolume = inputs.etfUpdate ? 0 : static_cast<signed long>(inputs.futBidVolume);
+    return market;
+}
+
+// The ETF/future cross decision made by OrderBookMessageHandler, as a pure
+// function of its inputs.
+//
+// We buy the ETF at its best ask when the future bid exceeds it, and sell
+// at the best bid when the future ask is below it, unless the inputs name a
+// passive price to quote instead. A live order at a stale
+// price is cancelled and replaced, subject to the position limit.
+//
+// Written without short-circuit operators or data-dependent branches so
+// that the lane-parallel form below vectorises.
+inline QuoteDecision DecideQuotes(const QuoteParameters& parameters,
+                                  const QuoteMarket& market,
+                                  const QuoteState& state) noexcept
+{
+    QuoteDecision decision;
+    decision.newAskPrice = (market.futBidPrice > market.askThreshold + parameters.minEdge) ? market.etfAskPrice : 0;
+    decision.newBidPrice = (market.futAskPrice + parameters.minEdge < market.bidThreshold) ? market.etfBidPrice : 0;
+    decision.askVolume = parameters.lotSize * market.lotSizeWeight + market.askBookVolume;
+    decision.bidVolume = parameters.lotSize * market.lotSizeWeight + market.bidBookVolume;
+
+    const signed long askWanted = QuoteFlag(decision.newAskPrice != 0);
+    const signed long bidWanted = QuoteFlag(decision.newBidPrice != 0);
+    decision.cancelAsk = state.askLive & askWanted & QuoteFlag(decision.newAskPrice != state.askPrice);
+    decision.cancelBid = state.bidLive & bidWanted & QuoteFlag(decision.newBidPrice != state.bidPrice);
+    decision.insertAsk = ((state.askLive ^ 1) | decision.cancelAsk) & askWanted
+                         & QuoteFlag(state.position < parameters.positionLimit);
+    decision.insertBid = ((state.bidLive ^ 1) | decision.cancelBid) & bidWanted
+                         & QuoteFlag(state.position > -parameters.positionLimit);
+    return decision;
+}
+
+inline QuoteDecision DecideQuotes(const QuoteParameters& parameters,
+                                  const QuoteInputs& inputs,
+                                  const QuoteState& state) noexcept
+{
+    return DecideQuotes(parameters, PrepareQuoteMarket(inputs), state);
+}
+
+// Everything an evaluation of the handler's quote decision depends on: the
+// prepared market, our order state, the exposure headroom on each side and
+// the next order id.
+struct QuoteKey
+{
+    QuoteMarket market;
+    QuoteState state;
+    unsigned long askHeadroom = 0;
+    unsigned long bidHeadroom = 0;
+    unsigned long nextOrderId = 0;
+};
+
+// A 64-bit digest of a QuoteKey, so that an audit record can show whether
+// two evaluations saw the same inputs without carrying them all.
+inline unsigned long QuoteKeyHash(const QuoteKey& key) noexcept
+{
+    const unsigned long fields[] = {
+            key.market.etfAskPrice, key.market.etfBidPrice,
+            static_cast<unsigned long>(key.market.futAskPrice), static_cast<unsigned long>(key.market.futBidPrice),
+            static_cast<unsigned long>(key.market.askThreshold), static_cast<unsigned long>(key.market.bidThreshold),
+            static_cast<unsigned long>(key.market.lotSizeWeight),
+            static_cast<unsigned long>(key.market.askBookVolume), static_cast<unsigned long>(key.market.bidBookVolume),
+            key.state.askPrice, key.state.bidPrice,
+            static_cast<unsigned long>(key.state.askLive), static_cast<unsigned long>(key.state.bidLive),
+            static_cast<unsigned long>(key.state.position),
+            key.askHeadroom, key.bidHeadroom, key.nextOrderId};
+    unsigned long hash = 0xcbf29ce484222325UL;
+    for (unsigned long field : fields)
+    {
+        hash = (hash ^ field) * 0x100000001b3UL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Skips quote evaluations whose inputs are those of the one before. That
+// evaluation cannot have cancelled or inserted anything, since either would
+// have changed our order state or used an order id, so it changed nothing
+// and neither would this one. On a quiet market most book messages leave
+// the top of book, and so the key, as it was.
+class QuoteEarlyOut
+{
+public:
+    // Returns true if the evaluation can be skipped, and otherwise
+    // remembers the key for the next one.
+    bool Unchanged(const QuoteKey& key) noexcept
+    {
+        ++mEvaluations;
+        const QuoteMarket& a = key.market;
+        const QuoteMarket& b = mLast.market;
+        const bool unchanged = mValid
+                               && a.etfAskPrice == b.etfAskPrice && a.etfBidPrice == b.etfBidPrice
+                               && a.futAskPrice == b.futAskPrice && a.futBidPrice == b.futBidPrice
+                               && a.askThreshold == b.askThreshold && a.bidThreshold == b.bidThreshold
+                               && a.lotSizeWeight == b.lotSizeWeight
+                               && a.askBookVolume == b.askBookVolume && a.bidBookVolume == b.bidBookVolume
+                               && key.state.askPrice == mLast.state.askPrice
+                               && key.state.bidPrice == mLast.state.bidPrice
+                               && key.state.askLive == mLast.state.askLive
+                               && key.state.bidLive == mLast.state.bidLive
+                               && key.state.position == mLast.state.position
+                               && key.askHeadroom == mLast.askHeadroom && key.bidHeadroom == mLast.bidHeadroom
+                               && key.nextOrderId == mLast.nextOrderId;
+        if (unchanged)
+        {
+            ++mSkips;
+            return true;
+        }
+        mLast = key;
+        mValid = true;
+        return false;
+    }
+
+    // Forget the last key, so that the next evaluation runs whatever its
+    // inputs, for when an evaluation's outcome was held back.
+    void Invalidate() noexcept
+    {
+        mValid = false;
+    }
+
+    unsigned long Evaluations() const noexcept { return mEvaluations; }
+    unsigned long Skips() const noexcept { return mSkips; }
+
+private:
+    QuoteKey mLast;
+    bool mValid = false;
+    unsigned long mEvaluations = 0;
+    unsigned long mSkips = 0;
+};
+
+constexpr std::size_t QUOTE_LANE_BLOCK = 8;
+
+// Many parameter sets and their simulated order state held as structure of
+// arrays, one lane per parameter set, so that DecideQuoteLanes evaluates a
+// market event for every lane in a single vectorised pass. The lane count is
+// padded to a multiple of QUOTE_LANE_BLOCK.
+struct QuoteLanes
+{
+    explicit QuoteLanes(std::size_t count)
+        : size((count + QUOTE_LANE_BLOCK - 1) / QUOTE_LANE_BLOCK * QUOTE_LANE_BLOCK),
+          minEdge(size), positionLimit(size), lotSize(size),
+          askPrice(size), bidPrice(size), askLive(size), bidLive(size), position(size),
+          newAskPrice(size), newBidPrice(size), askVolume(size), bidVolume(size),
+          cancelAsk(size), cancelBid(size), insertAsk(size), insertBid(size)
+    {
+    }
+
+    std::size_t size;
+
+    // Parameters.
+    std::vector<signed long> minEdge;
+    std::vector<signed long> positionLimit;
+    std::vector<signed long> lotSize;
+
+    // State, updated by the caller after applying each decision.
+    std::vector<unsigned long> askPrice;
+    std::vector<unsigned long> bidPrice;
+    std::vector<signed long> askLive;
+    std::vector<signed long> bidLive;
+    std::vector<signed long> position;
+
+    // Decision outputs; flags are zero or one.
+    std::vector<unsigned long> newAskPrice;
+    std::vector<unsigned long> newBidPrice;
+    std::vector<signed long> askVolume;
+    std::vector<signed long> bidVolume;
+    std::vector<signed long> cancelAsk;
+    std::vector<signed long> cancelBid;
+    std::vector<signed long> insertAsk;
+    std::vector<signed long> insertBid;
+};
+
+// Evaluate DecideQuotes for every lane against the same market inputs.
+inline void DecideQuoteLanes(QuoteLanes& lanes, const QuoteInputs& inputs) noexcept
+{
+    // The lane arrays never overlap; ivdep tells the compiler so, which it
+    // needs before it will vectorise the loop.
+    const std::size_t size = lanes.size;
+    const QuoteMarket market = PrepareQuoteMarket(inputs);
+    const signed long* minEdge = lanes.minEdge.data();
+    const signed long* positionLimit = lanes.positionLimit.data();
+    const signed long* lotSize = lanes.lotSize.data();
+    const unsigned long* askPrice = lanes.askPrice.data();
+    const unsigned long* bidPrice = lanes.bidPrice.data();
+    const signed long* askLive = lanes.askLive.data();
+    const signed long* bidLive = lanes.bidLive.data();
+    const signed long* position = lanes.position.data();
+    unsigned long* newAskPrice = lanes.newAskPrice.data();
+    unsigned long* newBidPrice = lanes.newBidPrice.data();
+    signed long* askVolume = lanes.askVolume.data();
+    signed long* bidVolume = lanes.bidVolume.data();
+    signed long* cancelAsk = lanes.cancelAsk.data();
+    signed long* cancelBid = lanes.cancelBid.data();
+    signed long* insertAsk = lanes.insertAsk.data();
+    signed long* insertBid = lanes.insertBid.data();
+
+#pragma GCC ivdep
+    for (std::size_t k = 0; k < size; ++k)
+    {
+        const QuoteParameters parameters{minEdge[k], positionLimit[k], lotSize[k]};
+        const QuoteState state{askPrice[k], bidPrice[k], askLive[k], bidLive[k], position[k]};
+        const QuoteDecision decision = DecideQuotes(parameters, market, state);
+        newAskPrice[k] = decision.newAskPrice;
+        newBidPrice[k] = decision.newBidPrice;
+        askVolume[k] = decision.askVolume;
+        bidVolume[k] = decision.bidVolume;
+        cancelAsk[k] = decision.cancelAsk;
+        cancelBid[k] = decision.cancelBid;
+        insertAsk[k] = decision.insertAsk;
+        insertBid[k] = decision.insertBid;
+    }
+}
+
+#endif //CPPREADY_TRADER_GO_QUOTEKERNEL_H
@@ -0,0 +1,137 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_ROUNDTRIP_H
+#define CPPREADY_TRADER_GO_ROUNDTRIP_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+constexpr std::size_t ROUND_TRIP_CAPACITY = 256;
+
+// One ETF fill and the hedge sent for it. The reference price is the
+// future price on the hedge's side when the ETF order filled, which the
+// hedge was sent at; hedge slippage is measured against it.
+struct RoundTrip
+{
+    unsigned long orderId = 0;
+    unsigned long hedgeId = 0;   // zero if the hedge was withheld
+    ReadyTraderGo::Side side = ReadyTraderGo::Side::BUY; // of the ETF fill
+    unsigned long price = 0;     // ETF fill price
+    unsigned long volume = 0;    // ETF fill volume
+    unsigned long referencePrice = 0;
+    unsigned long hedgePrice = 0;  // average hedge fill price
+    unsigned long hedgeVolume = 0; // hedge volume filled
+    std::chrono::nanoseconds filled{0};
+    std::chrono::nanoseconds hedged{0};
+
+    // Cents earned between the ETF fill and the hedge on the hedged lots.
+    signed long SpreadCapture() const noexcept
+    {
+        const signed long spread = static_cast<signed long>(hedgePrice) - static_cast<signed long>(price);
+        return Sign() * spread * static_cast<signed long>(hedgeVolume);
+    }
+
+    // Cents the hedge fills cost against the reference price; negative if
+    // they did better. Zero if the future had no price on that side.
+    signed long Slippage() const noexcept
+    {
+        if (referencePrice == 0)
+        {
+            return 0;
+        }
+        const signed long slip = static_cast<signed long>(referencePrice) - static_cast<signed long>(hedgePrice);
+        return Sign() * slip * static_cast<signed long>(hedgeVolume);
+    }
+
+    unsigned long UnhedgedVolume() const noexcept
+    {
+        return volume > hedgeVolume ? volume - hedgeVolume : 0;
+    }
+
+    std::chrono::nanoseconds TimeToHedge() const noexcept { return hedged - filled; }
+
+private:
+    // A bought ETF is hedged by selling the future, so a higher hedge price
+    // is better; the reverse for a sold ETF.
+    signed long Sign() const noexcept { return (side == ReadyTraderGo::Side::BUY) ? 1 : -1; }
+};
+
+// Completed round trips: the last ROUND_TRIP_CAPACITY of them in a ring,
+// totals over the ring for live statistics and totals over the session.
+class RoundTripLedger
+{
+public:
+    struct Totals
+    {
+        signed long count = 0;
+        signed long volume = 0;
+        signed long hedgeVolume = 0;
+        signed long spreadCapture = 0;
+        signed long slippage = 0;
+        std::chrono::nanoseconds timeToHedge{0}; // summed over hedged trips
+        signed long hedgedCount = 0;
+    };
+
+    void Record(const RoundTrip& trip) noexcept
+    {
+        RoundTrip& slot = mTrips[mNext % ROUND_TRIP_CAPACITY];
+        if (mNext >= ROUND_TRIP_CAPACITY)
+        {
+            Accumulate(mRecent, slot, -1);
+        }
+        slot = trip;
+        Accumulate(mRecent, trip, 1);
+        Accumulate(mSession, trip, 1);
+        ++mNext;
+    }
+
+    std::size_t Size() const noexcept { return mNext < ROUND_TRIP_CAPACITY ? mNext : ROUND_TRIP_CAPACITY; }
+
+    // The round trip completed age trips ago; age must be less than Size().
+    const RoundTrip& Recent(std::size_t age) const noexcept
+    {
+        return mTrips[(mNext - 1 - age) % ROUND_TRIP_CAPACITY];
+    }
+
+    // Totals over the trips still in the ring and over the whole session.
+    const Totals& RecentTotals() const noexcept { return mRecent; }
+    const Totals& SessionTotals() const noexcept { return mSession; }
+
+private:
+    static void Accumulate(Totals& totals, const RoundTrip& trip, signed long sign) noexcept
+    {
+        const bool hedged = trip.hedgeVolume != 0;
+        totals.count += sign;
+        totals.volume += sign * static_cast<signed long>(trip.volume);
+        totals.hedgeVolume += sign * static_cast<signed long>(trip.hedgeVolume);
+        totals.spreadCapture += sign * trip.SpreadCapture();
+        totals.slippage += sign * trip.Slippage();
+        totals.timeToHedge += hedged ? sign * trip.TimeToHedge() : std::chrono::nanoseconds(0);
+        totals.hedgedCount += hedged ? sign : 0;
+    }
+
+    std::array<RoundTrip, ROUND_TRIP_CAPACITY> mTrips{};
+    std::size_t mNext = 0;
+    Totals mRecent;
+    Totals mSession;
+};
+
+#endif //CPPREADY_TRADER_GO_ROUNDTRIP_H
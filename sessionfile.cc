@@ -0,0 +1,59 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "sessionfile.h"
+
+std::string NewSessionName()
+{
+    static std::atomic<unsigned long> sessions{0};
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::ostringstream name;
+    name << "session-" << now / 1000000 << '-' << std::setw(6) << std::setfill('0') << now % 1000000 << '-'
+         << ::getpid() << '-' << sessions.fetch_add(1);
+    return name.str();
+}
+
+std::FILE* CreateSessionFile(const std::string& directory,
+                             const std::string& session,
+                             const char* extension,
+                             std::string& filename,
+                             std::string& error)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directory, ec))
+    {
+        error = directory + " is not a directory";
+        return nullptr;
+    }
+
+    filename = (std::filesystem::path(directory) / (session + extension)).string();
+    std::FILE* file = std::fopen(filename.c_str(), "wbx");
+    if (file == nullptr)
+    {
+        error = "cannot create " + filename;
+    }
+    return file;
+}
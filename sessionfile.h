@@ -0,0 +1,41 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_SESSIONFILE_H
+#define CPPREADY_TRADER_GO_SESSIONFILE_H
+
+#include <cstdio>
+#include <string>
+
+// A name for one AutoTrader session's journal, audit and trace files:
+// session-<seconds>-<microseconds>-<pid>-<n>, where n counts the names
+// this process has handed out. Restarts, and several traders in one
+// process or on one machine, all get different names, and the names still
+// sort by start time.
+std::string NewSessionName();
+
+// Create <directory>/<session><extension> for writing, failing rather than
+// overwriting if the file already exists. Returns null and describes the
+// problem in error if the directory is missing or the file cannot be
+// created; otherwise sets filename to the file's path.
+std::FILE* CreateSessionFile(const std::string& directory,
+                             const std::string& session,
+                             const char* extension,
+                             std::string& filename,
+                             std::string& error);
+
+#endif //CPPREADY_TRADER_GO_SESSIONFILE_H
@@ -0,0 +1,189 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_SIGNALFEATURES_H
+#define CPPREADY_TRADER_GO_SIGNALFEATURES_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include <ready_trader_go/types.h>
+
+// Number of features presented to signal models. Kept a multiple of eight so
+// that the feature vector fills whole SIMD registers.
+constexpr std::size_t FEATURE_COUNT = 16;
+constexpr float FEATURE_TICK_SIZE = 100.0f;
+constexpr float TRADE_FLOW_DECAY = 0.9f;
+
+enum Feature : std::size_t
+{
+    ETF_SPREAD,
+    FUTURE_SPREAD,
+    BASIS,
+    CROSS_EDGE,
+    ETF_TOP_IMBALANCE,
+    FUTURE_TOP_IMBALANCE,
+    ETF_DEPTH_IMBALANCE,
+    FUTURE_DEPTH_IMBALANCE,
+    ETF_MICROPRICE_OFFSET,
+    FUTURE_MICROPRICE_OFFSET,
+    ETF_MID_CHANGE,
+    FUTURE_MID_CHANGE,
+    ETF_TRADE_FLOW,
+    FUTURE_TRADE_FLOW,
+    ETF_TRADE_VOLUME,
+    FUTURE_TRADE_VOLUME
+};
+
+constexpr std::array<const char*, FEATURE_COUNT> FEATURE_NAMES = {
+        "etf_spread", "future_spread", "basis", "cross_edge",
+        "etf_top_imbalance", "future_top_imbalance", "etf_depth_imbalance", "future_depth_imbalance",
+        "etf_microprice_offset", "future_microprice_offset", "etf_mid_change", "future_mid_change",
+        "etf_trade_flow", "future_trade_flow", "etf_trade_volume", "future_trade_volume"};
+
+using FeatureVector = std::array<float, FEATURE_COUNT>;
+
+// Incrementally maintained market features for both instruments, built
+// from the five-level order books and trade ticks.
+//
+// This is shared between the live OrderBookMessageHandler and the offline
+// research tools so that models are trained on exactly the features they
+// are evaluated on. Prices are expressed in ticks and volumes as ratios so
+// that the features are scale free.
+class SignalFeatures
+{
+public:
+    void OrderBook(ReadyTraderGo::Instrument instrument,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                   const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) noexcept
+    {
+        Book& book = mBooks[static_cast<std::size_t>(instrument)];
+        const float previousMid = book.mid;
+
+        book.bestAsk = static_cast<float>(askPrices[0]);
+        book.bestBid = static_cast<float>(bidPrices[0]);
+        if (askPrices[0] == 0 || bidPrices[0] == 0)
+        {
+            book.valid = false;
+            return;
+        }
+
+        float askDepth = 0.0f;
+        float bidDepth = 0.0f;
+        for (int i = 0; i < ReadyTraderGo::TOP_LEVEL_COUNT; ++i)
+        {
+            askDepth += static_cast<float>(askVolumes[i]);
+            bidDepth += static_cast<float>(bidVolumes[i]);
+        }
+
+        const float askTop = static_cast<float>(askVolumes[0]);
+        const float bidTop = static_cast<float>(bidVolumes[0]);
+        book.mid = 0.5f * (book.bestAsk + book.bestBid);
+        book.spread = (book.bestAsk - book.bestBid) / FEATURE_TICK_SIZE;
+        book.topImbalance = Ratio(bidTop - askTop, bidTop + askTop);
+        book.depthImbalance = Ratio(bidDepth - askDepth, bidDepth + askDepth);
+        book.micropriceOffset = (askTop + bidTop) != 0.0f
+                                ? ((book.bestAsk * bidTop + book.bestBid * askTop) / (askTop + bidTop) - book.mid)
+                                  / FEATURE_TICK_SIZE
+                                : 0.0f;
+        book.midChange = book.valid ? (book.mid - previousMid) / FEATURE_TICK_SIZE : 0.0f;
+        book.valid = true;
+    }
+
+    // Trade ticks report aggressive buying on the ask side and aggressive
+    // selling on the bid side; both are folded into decaying flow totals.
+    void TradeTicks(ReadyTraderGo::Instrument instrument,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                    const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) noexcept
+    {
+        Book& book = mBooks[static_cast<std::size_t>(instrument)];
+        float bought = 0.0f;
+        float sold = 0.0f;
+        for (int i = 0; i < ReadyTraderGo::TOP_LEVEL_COUNT; ++i)
+        {
+            bought += static_cast<float>(askVolumes[i]);
+            sold += static_cast<float>(bidVolumes[i]);
+        }
+        book.tradeFlow = book.tradeFlow * TRADE_FLOW_DECAY + (bought - sold);
+        book.tradeVolume = book.tradeVolume * TRADE_FLOW_DECAY + (bought + sold);
+    }
+
+    // Mid price of the given instrument in cents, or zero before the first
+    // two-sided book.
+    float Mid(ReadyTraderGo::Instrument instrument) const noexcept
+    {
+        const Book& book = mBooks[static_cast<std::size_t>(instrument)];
+        return book.valid ? book.mid : 0.0f;
+    }
+
+    bool Valid() const noexcept
+    {
+        return mBooks[0].valid && mBooks[1].valid;
+    }
+
+    void Compute(FeatureVector& features) const noexcept
+    {
+        const Book& etf = mBooks[static_cast<std::size_t>(ReadyTraderGo::Instrument::ETF)];
+        const Book& future = mBooks[static_cast<std::size_t>(ReadyTraderGo::Instrument::FUTURE)];
+
+        features[ETF_SPREAD] = etf.spread;
+        features[FUTURE_SPREAD] = future.spread;
+        features[BASIS] = (future.mid - etf.mid) / FEATURE_TICK_SIZE;
+        features[CROSS_EDGE] = std::fmax(future.bestBid - etf.bestAsk, etf.bestBid - future.bestAsk)
+                               / FEATURE_TICK_SIZE;
+        features[ETF_TOP_IMBALANCE] = etf.topImbalance;
+        features[FUTURE_TOP_IMBALANCE] = future.topImbalance;
+        features[ETF_DEPTH_IMBALANCE] = etf.depthImbalance;
+        features[FUTURE_DEPTH_IMBALANCE] = future.depthImbalance;
+        features[ETF_MICROPRICE_OFFSET] = etf.micropriceOffset;
+        features[FUTURE_MICROPRICE_OFFSET] = future.micropriceOffset;
+        features[ETF_MID_CHANGE] = etf.midChange;
+        features[FUTURE_MID_CHANGE] = future.midChange;
+        features[ETF_TRADE_FLOW] = Ratio(etf.tradeFlow, etf.tradeVolume);
+        features[FUTURE_TRADE_FLOW] = Ratio(future.tradeFlow, future.tradeVolume);
+        features[ETF_TRADE_VOLUME] = std::log1p(etf.tradeVolume);
+        features[FUTURE_TRADE_VOLUME] = std::log1p(future.tradeVolume);
+    }
+
+private:
+    struct Book
+    {
+        bool valid = false;
+        float bestAsk = 0.0f;
+        float bestBid = 0.0f;
+        float mid = 0.0f;
+        float spread = 0.0f;
+        float topImbalance = 0.0f;
+        float depthImbalance = 0.0f;
+        float micropriceOffset = 0.0f;
+        float midChange = 0.0f;
+        float tradeFlow = 0.0f;
+        float tradeVolume = 0.0f;
+    };
+
+    static float Ratio(float numerator, float denominator) noexcept
+    {
+        return denominator != 0.0f ? numerator / denominator : 0.0f;
+    }
+
+    std::array<Book, 2> mBooks;
+};
+
+#endif //CPPREADY_TRADER_GO_SIGNALFEATURES_H
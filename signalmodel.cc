@@ -0,0 +1,238 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cmath>
+#include <fstream>
+#include <string>
+
+#include "signalmodel.h"
+
+namespace
+{
+template<typename T>
+bool ReadValue(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool AllFinite(const float* values, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!std::isfinite(values[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+bool SignalModel::Load(const std::string& filename, std::string& error)
+{
+    mKind = SignalModelKind::NONE;
+
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    unsigned int magic = 0;
+    unsigned int version = 0;
+    unsigned int kind = 0;
+    unsigned int featureCount = 0;
+    if (!ReadValue(stream, magic) || !ReadValue(stream, version) || !ReadValue(stream, kind)
+        || !ReadValue(stream, featureCount))
+    {
+        error = "truncated header in " + filename;
+        return false;
+    }
+    if (magic != SIGNAL_MODEL_MAGIC || version != SIGNAL_MODEL_VERSION)
+    {
+        error = filename + " is not a version " + std::to_string(SIGNAL_MODEL_VERSION) + " signal model";
+        return false;
+    }
+    if (featureCount != FEATURE_COUNT)
+    {
+        error = filename + " expects " + std::to_string(featureCount) + " features but "
+                + std::to_string(FEATURE_COUNT) + " are available";
+        return false;
+    }
+
+    if (kind == static_cast<unsigned int>(SignalModelKind::LINEAR))
+    {
+        if (!ReadValue(stream, mBias) || !stream.read(reinterpret_cast<char*>(mWeights.data()),
+                                                      sizeof(float) * FEATURE_COUNT))
+        {
+            error = "truncated weights in " + filename;
+            return false;
+        }
+        if (!std::isfinite(mBias) || !AllFinite(mWeights.data(), FEATURE_COUNT))
+        {
+            error = "non-finite weights in " + filename;
+            return false;
+        }
+        mKind = SignalModelKind::LINEAR;
+        return true;
+    }
+
+    if (kind != static_cast<unsigned int>(SignalModelKind::OBLIVIOUS_TREES))
+    {
+        error = "unknown model kind " + std::to_string(kind) + " in " + filename;
+        return false;
+    }
+
+    unsigned int treeCount = 0;
+    unsigned int depth = 0;
+    if (!ReadValue(stream, treeCount) || !ReadValue(stream, depth) || !ReadValue(stream, mBias))
+    {
+        error = "truncated tree header in " + filename;
+        return false;
+    }
+    if (!std::isfinite(mBias))
+    {
+        error = "non-finite bias in " + filename;
+        return false;
+    }
+    if (treeCount > MAX_MODEL_TREES || depth == 0 || depth > MAX_TREE_DEPTH)
+    {
+        error = filename + " has " + std::to_string(treeCount) + " trees of depth " + std::to_string(depth)
+                + ", limits are " + std::to_string(MAX_MODEL_TREES) + " and " + std::to_string(MAX_TREE_DEPTH);
+        return false;
+    }
+
+    mSplitFeatures.fill(0);
+    mSplitThresholds.fill(0.0f);
+    mLeaves.fill(0.0f);
+    const std::size_t leafCount = std::size_t(1) << depth;
+    for (std::size_t t = 0; t < treeCount; ++t)
+    {
+        for (std::size_t d = 0; d < depth; ++d)
+        {
+            unsigned int feature = 0;
+            if (!ReadValue(stream, feature))
+            {
+                error = "truncated tree " + std::to_string(t) + " in " + filename;
+                return false;
+            }
+            if (feature >= FEATURE_COUNT)
+            {
+                error = "tree " + std::to_string(t) + " splits on unknown feature " + std::to_string(feature);
+                return false;
+            }
+            mSplitFeatures[d * MAX_MODEL_TREES + t] = feature;
+        }
+        for (std::size_t d = 0; d < depth; ++d)
+        {
+            float& threshold = mSplitThresholds[d * MAX_MODEL_TREES + t];
+            if (!ReadValue(stream, threshold))
+            {
+                error = "truncated tree " + std::to_string(t) + " in " + filename;
+                return false;
+            }
+            if (!std::isfinite(threshold))
+            {
+                error = "tree " + std::to_string(t) + " has a non-finite threshold in " + filename;
+                return false;
+            }
+        }
+        if (!stream.read(reinterpret_cast<char*>(&mLeaves[t << MAX_TREE_DEPTH]), sizeof(float) * leafCount))
+        {
+            error = "truncated tree " + std::to_string(t) + " in " + filename;
+            return false;
+        }
+        if (!AllFinite(&mLeaves[t << MAX_TREE_DEPTH], leafCount))
+        {
+            error = "tree " + std::to_string(t) + " has non-finite leaves in " + filename;
+            return false;
+        }
+    }
+
+    mTreeDepth = depth;
+    mKind = SignalModelKind::OBLIVIOUS_TREES;
+    return true;
+}
+
+float SignalModel::Evaluate(const FeatureVector& features) const noexcept
+{
+    switch (mKind)
+    {
+    case SignalModelKind::LINEAR:
+        return EvaluateLinear(features);
+    case SignalModelKind::OBLIVIOUS_TREES:
+        return EvaluateTrees(features);
+    default:
+        return 0.0f;
+    }
+}
+
+float SignalModel::EvaluateLinear(const FeatureVector& features) const noexcept
+{
+    // Independent partial sums per lane let the compiler keep the products in
+    // vector registers without reassociating floating point additions.
+    std::array<float, SIGNAL_LANE_COUNT> sums{};
+    for (std::size_t i = 0; i < FEATURE_COUNT; i += SIGNAL_LANE_COUNT)
+    {
+        for (std::size_t j = 0; j < SIGNAL_LANE_COUNT; ++j)
+        {
+            sums[j] += mWeights[i + j] * features[i + j];
+        }
+    }
+
+    float result = mBias;
+    for (float sum : sums)
+    {
+        result += sum;
+    }
+    return result;
+}
+
+float SignalModel::EvaluateTrees(const FeatureVector& features) const noexcept
+{
+    // Trees are processed a whole level at a time; every tree accumulates one
+    // bit of its leaf index per level, so there are no data-dependent branches.
+    std::array<unsigned int, MAX_MODEL_TREES> leafIndices{};
+    for (std::size_t d = 0; d < mTreeDepth; ++d)
+    {
+        const unsigned int* splitFeatures = &mSplitFeatures[d * MAX_MODEL_TREES];
+        const float* splitThresholds = &mSplitThresholds[d * MAX_MODEL_TREES];
+        for (std::size_t t = 0; t < MAX_MODEL_TREES; ++t)
+        {
+            leafIndices[t] |= static_cast<unsigned int>(features[splitFeatures[t]] > splitThresholds[t]) << d;
+        }
+    }
+
+    // Unused trees have all-zero leaves, so summing the full fixed-size
+    // ensemble keeps the cost constant regardless of the loaded model.
+    std::array<float, SIGNAL_LANE_COUNT> sums{};
+    for (std::size_t t = 0; t < MAX_MODEL_TREES; t += SIGNAL_LANE_COUNT)
+    {
+        for (std::size_t j = 0; j < SIGNAL_LANE_COUNT; ++j)
+        {
+            sums[j] += mLeaves[((t + j) << MAX_TREE_DEPTH) + leafIndices[t + j]];
+        }
+    }
+
+    float result = mBias;
+    for (float sum : sums)
+    {
+        result += sum;
+    }
+    return result;
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_SIGNALMODEL_H
+#define CPPREADY_TRADER_GO_SIGNALMODEL_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include "signalfeatures.h"
+
+// Hard limits on model size. Together they bound evaluation to a fixed
+// number of comparisons and additions per order book message.
+constexpr std::size_t MAX_MODEL_TREES = 64;
+constexpr std::size_t MAX_TREE_DEPTH = 6;
+constexpr std::size_t SIGNAL_LANE_COUNT = 8;
+
+constexpr unsigned int SIGNAL_MODEL_MAGIC = 0x4d475452; // "RTGM"
+constexpr unsigned int SIGNAL_MODEL_VERSION = 1;
+
+enum class SignalModelKind : unsigned int
+{
+    NONE = 0,
+    LINEAR = 1,
+    OBLIVIOUS_TREES = 2
+};
+
+// A small learned model mapping a FeatureVector to a predicted ETF fair
+// value offset, in ticks.
+//
+// Two model kinds are supported: a linear model and an ensemble of
+// oblivious (symmetric) decision trees, in which every node on a level
+// shares one split so that a tree is evaluated by turning depth comparisons
+// into the bits of a leaf index rather than by branching. Weights are held
+// in fixed-size aligned arrays so evaluation never allocates.
+//
+// Model files are little-endian binary:
+//   uint32 magic, uint32 version, uint32 kind, uint32 feature count
+//   LINEAR:          float bias, float weights[feature count]
+//   OBLIVIOUS_TREES: uint32 tree count, uint32 depth, float bias, then per
+//                    tree: uint32 split features[depth],
+//                    float split thresholds[depth], float leaves[2^depth]
+// A tree's leaf index has bit d set when feature[d] > threshold[d].
+class SignalModel
+{
+public:
+    // Load a model file. Returns false and describes the problem in error if
+    // the file cannot be used, including if any weight, threshold or leaf is
+    // not finite, in which case the model stays disabled.
+    bool Load(const std::string& filename, std::string& error);
+
+    bool Enabled() const noexcept { return mKind != SignalModelKind::NONE; }
+    SignalModelKind Kind() const noexcept { return mKind; }
+
+    // Predicted fair value offset in ticks, or zero if no model is loaded.
+    float Evaluate(const FeatureVector& features) const noexcept;
+
+private:
+    float EvaluateLinear(const FeatureVector& features) const noexcept;
+    float EvaluateTrees(const FeatureVector& features) const noexcept;
+
+    SignalModelKind mKind = SignalModelKind::NONE;
+    float mBias = 0.0f;
+    std::size_t mTreeDepth = 0;
+    alignas(32) std::array<float, FEATURE_COUNT> mWeights{};
+
+    // Splits are stored level-major ([level][tree]) so that one level of
+    // every tree is evaluated in a single pass over contiguous memory.
+    alignas(32) std::array<unsigned int, MAX_TREE_DEPTH * MAX_MODEL_TREES> mSplitFeatures{};
+    alignas(32) std::array<float, MAX_TREE_DEPTH * MAX_MODEL_TREES> mSplitThresholds{};
+    alignas(32) std::array<float, MAX_MODEL_TREES << MAX_TREE_DEPTH> mLeaves{};
+};
+
+#endif //CPPREADY_TRADER_GO_SIGNALMODEL_H
@@ -0,0 +1,85 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_SPSCRING_H
+#define CPPREADY_TRADER_GO_SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free ring buffer for exactly one producer thread and one
+// consumer thread.
+//
+// Each side keeps a private copy of the other side's index so that the shared
+// cache line is only touched when the ring looks full (producer) or empty
+// (consumer).
+template<typename T, std::size_t Capacity>
+class SPSCRing
+{
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Called by the producer. Returns false, leaving the ring untouched, if
+    // the ring is full.
+    bool TryPush(const T& item) noexcept
+    {
+        const std::size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mCachedHead == Capacity)
+        {
+            mCachedHead = mHead.load(std::memory_order_acquire);
+            if (tail - mCachedHead == Capacity)
+                return false;
+        }
+        mItems[tail & (Capacity - 1)] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer. Returns false if the ring is empty.
+    bool TryPop(T& item) noexcept
+    {
+        const std::size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mCachedTail)
+        {
+            mCachedTail = mTail.load(std::memory_order_acquire);
+            if (head == mCachedTail)
+                return false;
+        }
+        item = mItems[head & (Capacity - 1)];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of items in the ring; exact only when called from
+    // one of the two participating threads while the other is idle.
+    std::size_t Size() const noexcept
+    {
+        return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mHead{0};
+    std::size_t mCachedTail = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mTail{0};
+    std::size_t mCachedHead = 0;
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> mItems{};
+};
+
+#endif //CPPREADY_TRADER_GO_SPSCRING_H
@@ -0,0 +1,113 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_SWEEPDETECTOR_H
+#define CPPREADY_TRADER_GO_SWEEPDETECTOR_H
+
+#include <array>
+#include <chrono>
+
+#include <ready_trader_go/types.h>
+
+// A single trade ticks message that trades through at least this many
+// price levels on a side, for at least SWEEP_MIN_VOLUME lots, is a sweep.
+constexpr int SWEEP_MIN_LEVELS = 2;
+constexpr unsigned long SWEEP_MIN_VOLUME = 40;
+
+// Aggressive volume on one side of one instrument reaching this within the
+// burst window is a burst, however many levels it traded at.
+constexpr unsigned long BURST_MIN_VOLUME = 150;
+constexpr std::chrono::nanoseconds BURST_WINDOW = std::chrono::milliseconds(500);
+
+// Which way the market was just swept. Buyers lifting the asks put our sell
+// quote at risk, and sellers hitting the bids our buy quote.
+struct SweepSignal
+{
+    bool up = false;
+    bool down = false;
+};
+
+// Flags sweeps and bursts of aggressive trading from trade ticks.
+//
+// Each message costs one comparison per side for the level count, a sum
+// of the five volumes, and a window check: the window restarts with the
+// first tick after it expires rather than sliding, so no tick history is
+// kept.
+class SweepDetector
+{
+public:
+    SweepSignal TradeTicks(ReadyTraderGo::Instrument instrument,
+                           std::chrono::nanoseconds now,
+                           const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                           const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                           const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                           const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) noexcept
+    {
+        Windows& windows = mWindows[static_cast<std::size_t>(instrument)];
+        SweepSignal signal;
+        signal.up = Check(windows.bought, now, askPrices, askVolumes);
+        signal.down = Check(windows.sold, now, bidPrices, bidVolumes);
+        return signal;
+    }
+
+private:
+    struct Window
+    {
+        std::chrono::nanoseconds start{0};
+        unsigned long volume = 0;
+    };
+
+    struct Windows
+    {
+        Window bought;
+        Window sold;
+    };
+
+    static bool Check(Window& window,
+                      std::chrono::nanoseconds now,
+                      const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& prices,
+                      const std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& volumes) noexcept
+    {
+        // Traded prices are packed from the front, so the level count
+        // reaches SWEEP_MIN_LEVELS exactly when that slot is filled.
+        unsigned long volume = 0;
+        for (int i = 0; i < ReadyTraderGo::TOP_LEVEL_COUNT; ++i)
+        {
+            volume += volumes[i];
+        }
+        const bool sweep = prices[SWEEP_MIN_LEVELS - 1] != 0 && volume >= SWEEP_MIN_VOLUME;
+
+        if (now - window.start > BURST_WINDOW)
+        {
+            window.start = now;
+            window.volume = 0;
+        }
+        window.volume += volume;
+        const bool burst = window.volume >= BURST_MIN_VOLUME;
+        if (burst)
+        {
+            // Start afresh so that one burst pulls the quote once.
+            window.start = now;
+            window.volume = 0;
+        }
+        return sweep || burst;
+    }
+
+    std::array<Windows, 2> mWindows;
+};
+
+#endif //CPPREADY_TRADER_GO_SWEEPDETECTOR_H
@@ -0,0 +1,148 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "auditlog.h"
+
+// Answers questions about the AutoTrader's audit trail. Without an order id
+// it counts evaluations by action and by each side's reason; with one it
+// prints the evaluations at which that order appeared and disappeared,
+// which is to say why it was sent and what became of it.
+
+static std::string ActionString(unsigned char action)
+{
+    if (action & AUDIT_SKIPPED)
+    {
+        return "skip";
+    }
+    std::string result;
+    const std::array<std::pair<unsigned char, const char*>, 5> names{{
+            {AUDIT_SWEEP, "sweep"}, {AUDIT_CANCEL_ASK, "cancel-ask"}, {AUDIT_CANCEL_BID, "cancel-bid"},
+            {AUDIT_INSERT_ASK, "insert-ask"}, {AUDIT_INSERT_BID, "insert-bid"}}};
+    for (const auto& [flag, name] : names)
+    {
+        if (action & flag)
+        {
+            result += result.empty() ? name : std::string("+") + name;
+        }
+    }
+    return result.empty() ? "none" : result;
+}
+
+static void PrintRecord(const AuditRecord& record)
+{
+    std::cout << std::setw(20) << record.timestamp << ' '
+              << (record.instrument == ReadyTraderGo::Instrument::ETF ? "etf    " : "future ")
+              << std::left << std::setw(24) << ActionString(record.action)
+              << std::setw(16) << AuditReasonName(record.askReason)
+              << std::setw(16) << AuditReasonName(record.bidReason) << std::right
+              << std::setw(8) << record.askId << std::setw(8) << record.bidId << "  "
+              << std::hex << std::setw(16) << std::setfill('0') << record.inputsHash
+              << std::dec << std::setfill(' ') << '\n';
+}
+
+static void TraceOrder(const std::vector<AuditRecord>& records, unsigned long clientOrderId)
+{
+    bool live = false;
+    for (const AuditRecord& record : records)
+    {
+        const bool present = record.askId == clientOrderId || record.bidId == clientOrderId;
+        if (present != live)
+        {
+            PrintRecord(record);
+            live = present;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> paths;
+    unsigned long clientOrderId = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--order") == 0 && i + 1 < argc)
+        {
+            clientOrderId = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            paths.emplace_back(argv[i]);
+        }
+    }
+    if (paths.empty())
+    {
+        std::cerr << "usage: " << argv[0] << " <audit file or directory>... [--order <client order id>]"
+                  << std::endl;
+        return 1;
+    }
+
+    unsigned long evaluations = 0;
+    unsigned long skipped = 0;
+    std::array<std::array<unsigned long, AUDIT_REASON_COUNT>, 2> reasons{};
+    for (const std::string& path : paths)
+    {
+        const std::vector<std::string> filenames = std::filesystem::is_directory(path)
+                                                   ? ListAudits(path)
+                                                   : std::vector<std::string>{path};
+        for (const std::string& filename : filenames)
+        {
+            std::vector<AuditRecord> records;
+            std::string error;
+            if (!ReadAudit(filename, records, error))
+            {
+                std::cerr << "skipping " << error << std::endl;
+                continue;
+            }
+            if (clientOrderId != 0)
+            {
+                std::cout << filename << ":\n";
+                TraceOrder(records, clientOrderId);
+                continue;
+            }
+            for (const AuditRecord& record : records)
+            {
+                evaluations += 1;
+                skipped += (record.action & AUDIT_SKIPPED) ? 1 : 0;
+                reasons[0][static_cast<std::size_t>(record.askReason) % AUDIT_REASON_COUNT] += 1;
+                reasons[1][static_cast<std::size_t>(record.bidReason) % AUDIT_REASON_COUNT] += 1;
+            }
+        }
+    }
+    if (clientOrderId != 0)
+    {
+        return 0;
+    }
+
+    std::cout << evaluations << " records, " << skipped << " skipped as unchanged\n";
+    std::cout << std::left << std::setw(18) << "reason" << std::right << std::setw(12) << "ask (buy)"
+              << std::setw(12) << "bid (sell)" << '\n';
+    for (std::size_t i = 0; i < AUDIT_REASON_COUNT; ++i)
+    {
+        std::cout << std::left << std::setw(18) << AuditReasonName(static_cast<AuditReason>(i)) << std::right
+                  << std::setw(12) << reasons[0][i] << std::setw(12) << reasons[1][i] << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchstore.h"
+
+// Compares the benchmark samples stored for two commits.
+//
+// Each benchmark's runs are compared with a two-sided Mann-Whitney U test,
+// which makes no assumption about the shape of the timing distribution and
+// is robust to the occasional outlier run. A benchmark is flagged when the
+// difference is significant and its median moved by more than the noise
+// threshold; the exit status is non-zero if anything regressed.
+
+constexpr double DEFAULT_ALPHA = 0.01;
+constexpr double NOISE_THRESHOLD = 0.02;
+constexpr char DEFAULT_STORE[] = "benchmarks";
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const std::size_t middle = values.size() / 2;
+    return (values.size() % 2 == 1) ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+// Two-sided p-value of the Mann-Whitney U test by the normal approximation,
+// with tie and continuity corrections.
+static double MannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const double n1 = static_cast<double>(a.size());
+    const double n2 = static_cast<double>(b.size());
+    std::vector<std::pair<double, int>> pooled;
+    for (double value : a)
+    {
+        pooled.emplace_back(value, 0);
+    }
+    for (double value : b)
+    {
+        pooled.emplace_back(value, 1);
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    double rankSumA = 0.0;
+    double tieTerm = 0.0;
+    for (std::size_t i = 0; i < pooled.size();)
+    {
+        std::size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+        {
+            ++j;
+        }
+        const double rank = (static_cast<double>(i + j) + 1.0) / 2.0;
+        const double ties = static_cast<double>(j - i);
+        tieTerm += ties * ties * ties - ties;
+        for (std::size_t k = i; k < j; ++k)
+        {
+            rankSumA += pooled[k].second == 0 ? rank : 0.0;
+        }
+        i = j;
+    }
+
+    const double n = n1 + n2;
+    const double u = rankSumA - n1 * (n1 + 1.0) / 2.0;
+    const double mean = n1 * n2 / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)));
+    if (variance <= 0.0)
+    {
+        return 1.0;
+    }
+    const double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 5)
+    {
+        std::cerr << "usage: " << argv[0] << " <baseline commit> <candidate commit> [alpha] [results directory]"
+                  << std::endl;
+        return 1;
+    }
+
+    const double alpha = (argc > 3) ? std::atof(argv[3]) : DEFAULT_ALPHA;
+    const std::string store = (argc > 4) ? argv[4] : DEFAULT_STORE;
+    BenchmarkSamples baseline;
+    BenchmarkSamples candidate;
+    std::string error;
+    if (!ReadBenchmarkSamples(store, argv[1], baseline, error) || !ReadBenchmarkSamples(store, argv[2], candidate, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    unsigned long regressions = 0;
+    std::cout << std::left << std::setw(24) << "benchmark" << std::right << std::setw(12) << "baseline"
+              << std::setw(12) << "candidate" << std::setw(9) << "change" << std::setw(10) << "p" << "\n";
+    for (const auto& [name, before] : baseline)
+    {
+        auto it = candidate.find(name);
+        if (it == candidate.end())
+        {
+            std::cout << std::left << std::setw(24) << name << " missing from candidate\n";
+            continue;
+        }
+
+        const std::vector<double>& after = it->second;
+        const double beforeMedian = Median(before);
+        const double afterMedian = Median(after);
+        const double change = (afterMedian - beforeMedian) / beforeMedian;
+        const double p = MannWhitneyPValue(before, after);
+        const bool significant = p < alpha && std::abs(change) > NOISE_THRESHOLD;
+        const char* verdict = !significant ? "" : (change > 0.0) ? "  REGRESSION" : "  improvement";
+        regressions += (significant && change > 0.0) ? 1 : 0;
+
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << beforeMedian << std::setw(12) << afterMedian << std::setw(8)
+                  << 100.0 * change << '%' << std::setprecision(4) << std::setw(10) << p << verdict
+                  << "  (" << before.size() << " vs " << after.size() << " runs)\n";
+    }
+    return regressions == 0 ? 0 : 1;
+}
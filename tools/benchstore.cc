@@ -0,0 +1,82 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "benchstore.h"
+
+constexpr char BENCHMARK_EXTENSION[] = ".tsv";
+
+static std::filesystem::path StorePath(const std::string& directory, const std::string& commit)
+{
+    return std::filesystem::path(directory) / (commit + BENCHMARK_EXTENSION);
+}
+
+bool AppendBenchmarkSamples(const std::string& directory, const std::string& commit,
+                            const BenchmarkSamples& samples, std::string& error)
+{
+    std::error_code code;
+    std::filesystem::create_directories(directory, code);
+    const std::filesystem::path path = StorePath(directory, commit);
+    std::ofstream file(path, std::ios::app);
+    if (!file)
+    {
+        error = "cannot open " + path.string();
+        return false;
+    }
+
+    file.precision(17);
+    for (const auto& [name, values] : samples)
+    {
+        for (double value : values)
+        {
+            file << name << '\t' << value << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+bool ReadBenchmarkSamples(const std::string& directory, const std::string& commit, BenchmarkSamples& samples,
+                          std::string& error)
+{
+    const std::filesystem::path path = StorePath(directory, commit);
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "no results for " + commit + " in " + directory;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const std::size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+        {
+            continue;
+        }
+        std::istringstream value(line.substr(tab + 1));
+        double sample = 0.0;
+        if (value >> sample)
+        {
+            samples[line.substr(0, tab)].push_back(sample);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_BENCHSTORE_H
+#define CPPREADY_TRADER_GO_TOOLS_BENCHSTORE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Benchmark samples keyed by benchmark name. Every sample is a cost, in
+// nanoseconds per event, so lower is always better; throughput is stored
+// as its reciprocal.
+using BenchmarkSamples = std::map<std::string, std::vector<double>>;
+
+// A local results store: one text file per commit in a directory, with a
+// "name<TAB>value" line per sample. Repeated runs for the same commit are
+// appended, so samples accumulate until there are enough for a test.
+bool AppendBenchmarkSamples(const std::string& directory, const std::string& commit,
+                            const BenchmarkSamples& samples, std::string& error);
+
+bool ReadBenchmarkSamples(const std::string& directory, const std::string& commit, BenchmarkSamples& samples,
+                          std::string& error);
+
+#endif //CPPREADY_TRADER_GO_TOOLS_BENCHSTORE_H
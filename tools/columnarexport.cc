@@ -0,0 +1,264 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "columnar.h"
+#include "journal.h"
+#include "parallel.h"
+
+using namespace ReadyTraderGo;
+
+// Converts session journals into columnar files that analysis tools can map
+// and scan directly.
+//
+// Each journal becomes one file holding these tables, distinguished by
+// column name prefix:
+//   etf.book, future.book     five-level order books
+//   etf.ticks, future.ticks   five-level trade ticks
+//   orders                    insert orders sent
+//   cancels                   cancel orders sent
+//   hedges                    hedge orders sent
+//   fills                     ETF order fills
+//   hedge_fills               hedge order fills
+//   status                    order status updates
+
+constexpr char COLUMNAR_EXTENSION[] = ".rtgc";
+
+struct LevelTable
+{
+    std::vector<std::int64_t> timestamps;
+    std::vector<std::uint64_t> sequenceNumbers;
+    std::array<std::vector<std::uint64_t>, TOP_LEVEL_COUNT> askPrices;
+    std::array<std::vector<std::uint64_t>, TOP_LEVEL_COUNT> askVolumes;
+    std::array<std::vector<std::uint64_t>, TOP_LEVEL_COUNT> bidPrices;
+    std::array<std::vector<std::uint64_t>, TOP_LEVEL_COUNT> bidVolumes;
+
+    void Add(const JournalRecord& record)
+    {
+        timestamps.push_back(record.timestamp);
+        sequenceNumbers.push_back(record.sequenceNumber);
+        for (int i = 0; i < TOP_LEVEL_COUNT; ++i)
+        {
+            askPrices[i].push_back(record.askPrices[i]);
+            askVolumes[i].push_back(record.askVolumes[i]);
+            bidPrices[i].push_back(record.bidPrices[i]);
+            bidVolumes[i].push_back(record.bidVolumes[i]);
+        }
+    }
+
+    void Write(const std::string& prefix, ColumnarWriter& writer) const
+    {
+        writer.AddColumn(prefix + ".timestamp", timestamps);
+        writer.AddColumn(prefix + ".sequence", sequenceNumbers);
+        for (int i = 0; i < TOP_LEVEL_COUNT; ++i)
+        {
+            const std::string level = std::to_string(i);
+            writer.AddColumn(prefix + ".ask_price_" + level, askPrices[i]);
+            writer.AddColumn(prefix + ".ask_volume_" + level, askVolumes[i]);
+            writer.AddColumn(prefix + ".bid_price_" + level, bidPrices[i]);
+            writer.AddColumn(prefix + ".bid_volume_" + level, bidVolumes[i]);
+        }
+    }
+};
+
+struct OrderTable
+{
+    std::vector<std::int64_t> timestamps;
+    std::vector<std::uint64_t> clientOrderIds;
+    std::vector<std::uint8_t> sides;
+    std::vector<std::uint64_t> prices;
+    std::vector<std::uint64_t> volumes;
+    std::vector<std::uint8_t> lifespans;
+
+    void Add(const JournalRecord& record)
+    {
+        timestamps.push_back(record.timestamp);
+        clientOrderIds.push_back(record.clientOrderId);
+        sides.push_back(static_cast<std::uint8_t>(record.side));
+        prices.push_back(record.price);
+        volumes.push_back(record.volume);
+        lifespans.push_back(static_cast<std::uint8_t>(record.lifespan));
+    }
+
+    void Write(const std::string& prefix, ColumnarWriter& writer, bool withLifespan) const
+    {
+        writer.AddColumn(prefix + ".timestamp", timestamps);
+        writer.AddColumn(prefix + ".client_order_id", clientOrderIds);
+        writer.AddColumn(prefix + ".side", sides);
+        writer.AddColumn(prefix + ".price", prices);
+        writer.AddColumn(prefix + ".volume", volumes);
+        if (withLifespan)
+        {
+            writer.AddColumn(prefix + ".lifespan", lifespans);
+        }
+    }
+};
+
+struct FillTable
+{
+    std::vector<std::int64_t> timestamps;
+    std::vector<std::uint64_t> clientOrderIds;
+    std::vector<std::uint64_t> prices;
+    std::vector<std::uint64_t> volumes;
+
+    void Add(const JournalRecord& record)
+    {
+        timestamps.push_back(record.timestamp);
+        clientOrderIds.push_back(record.clientOrderId);
+        prices.push_back(record.price);
+        volumes.push_back(record.volume);
+    }
+
+    void Write(const std::string& prefix, ColumnarWriter& writer) const
+    {
+        writer.AddColumn(prefix + ".timestamp", timestamps);
+        writer.AddColumn(prefix + ".client_order_id", clientOrderIds);
+        writer.AddColumn(prefix + ".price", prices);
+        writer.AddColumn(prefix + ".volume", volumes);
+    }
+};
+
+struct StatusTable
+{
+    std::vector<std::int64_t> timestamps;
+    std::vector<std::uint64_t> clientOrderIds;
+    std::vector<std::uint64_t> fillVolumes;
+    std::vector<std::uint64_t> remainingVolumes;
+    std::vector<std::int64_t> fees;
+
+    void Add(const JournalRecord& record)
+    {
+        timestamps.push_back(record.timestamp);
+        clientOrderIds.push_back(record.clientOrderId);
+        fillVolumes.push_back(record.volume);
+        remainingVolumes.push_back(record.remainingVolume);
+        fees.push_back(record.fees);
+    }
+
+    void Write(const std::string& prefix, ColumnarWriter& writer) const
+    {
+        writer.AddColumn(prefix + ".timestamp", timestamps);
+        writer.AddColumn(prefix + ".client_order_id", clientOrderIds);
+        writer.AddColumn(prefix + ".fill_volume", fillVolumes);
+        writer.AddColumn(prefix + ".remaining_volume", remainingVolumes);
+        writer.AddColumn(prefix + ".fees", fees);
+    }
+};
+
+static bool Export(const std::string& journal, const std::string& output, std::string& error)
+{
+    std::vector<JournalRecord> records;
+    if (!ReadJournal(journal, records, error))
+    {
+        return false;
+    }
+
+    std::array<LevelTable, 2> books;
+    std::array<LevelTable, 2> ticks;
+    OrderTable orders;
+    OrderTable cancels;
+    OrderTable hedges;
+    FillTable fills;
+    FillTable hedgeFills;
+    StatusTable status;
+    for (const JournalRecord& record : records)
+    {
+        switch (record.type)
+        {
+        case JournalRecordType::ORDER_BOOK:
+            books[static_cast<std::size_t>(record.instrument)].Add(record);
+            break;
+        case JournalRecordType::TRADE_TICKS:
+            ticks[static_cast<std::size_t>(record.instrument)].Add(record);
+            break;
+        case JournalRecordType::INSERT_ORDER:
+            orders.Add(record);
+            break;
+        case JournalRecordType::CANCEL_ORDER:
+            cancels.Add(record);
+            break;
+        case JournalRecordType::HEDGE_ORDER:
+            hedges.Add(record);
+            break;
+        case JournalRecordType::ORDER_FILLED:
+            fills.Add(record);
+            break;
+        case JournalRecordType::HEDGE_FILLED:
+            hedgeFills.Add(record);
+            break;
+        case JournalRecordType::ORDER_STATUS:
+            status.Add(record);
+            break;
+        default:
+            break;
+        }
+    }
+
+    ColumnarWriter writer;
+    books[static_cast<std::size_t>(Instrument::ETF)].Write("etf.book", writer);
+    books[static_cast<std::size_t>(Instrument::FUTURE)].Write("future.book", writer);
+    ticks[static_cast<std::size_t>(Instrument::ETF)].Write("etf.ticks", writer);
+    ticks[static_cast<std::size_t>(Instrument::FUTURE)].Write("future.ticks", writer);
+    orders.Write("orders", writer, true);
+    writer.AddColumn("cancels.timestamp", cancels.timestamps);
+    writer.AddColumn("cancels.client_order_id", cancels.clientOrderIds);
+    hedges.Write("hedges", writer, false);
+    fills.Write("fills", writer);
+    hedgeFills.Write("hedge_fills", writer);
+    status.Write("status", writer);
+    return writer.Write(output, error);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal file or directory> [output directory]" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path input(argv[1]);
+    const std::vector<std::string> journals = std::filesystem::is_directory(input)
+                                              ? ListJournals(input.string())
+                                              : std::vector<std::string>{input.string()};
+    const std::filesystem::path outputDirectory = (argc == 3) ? std::filesystem::path(argv[2])
+                                                              : std::filesystem::path(".");
+
+    std::vector<std::string> errors(journals.size());
+    ParallelFor(journals.size(), [&](std::size_t i) {
+        std::filesystem::path output = outputDirectory / std::filesystem::path(journals[i]).filename();
+        output.replace_extension(COLUMNAR_EXTENSION);
+        Export(journals[i], output.string(), errors[i]);
+    });
+
+    int result = 0;
+    for (std::size_t i = 0; i < journals.size(); ++i)
+    {
+        if (!errors[i].empty())
+        {
+            std::cerr << journals[i] << ": " << errors[i] << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
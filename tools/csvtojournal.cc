@@ -0,0 +1,408 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "orderbook.h"
+#include "parallel.h"
+
+using namespace ReadyTraderGo;
+
+// Converts a Ready Trader Go market data CSV file into a session journal.
+//
+// The CSV holds the exchange's order-level events:
+//   Time,Instrument,Operation,OrderId,Side,Volume,Price,Lifespan,Fee
+// Parsing is split into newline-aligned chunks handled in parallel, with
+// numeric fields decoded eight digits at a time using SWAR (SIMD within a
+// register) arithmetic. The events are then applied in order to a matching
+// order book per instrument, which is snapshotted every book interval into
+// ORDER_BOOK and TRADE_TICKS records exactly as the AutoTrader would have
+// received them.
+
+constexpr std::chrono::milliseconds DEFAULT_BOOK_INTERVAL{250};
+constexpr std::size_t CSV_PADDING = 16;
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+constexpr std::uint64_t NANOSECONDS_PER_SECOND = 1000000000;
+constexpr std::array<std::uint64_t, 10> POWERS_OF_TEN = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+enum class Operation : unsigned char
+{
+    INSERT,
+    CANCEL,
+    AMEND
+};
+
+struct MarketDataRow
+{
+    std::int64_t time;
+    Instrument instrument;
+    Operation operation;
+    Side side;
+    Lifespan lifespan;
+    unsigned long orderId;
+    unsigned long volume;
+    unsigned long price;
+};
+
+static std::uint64_t LoadEight(const char* p) noexcept
+{
+    std::uint64_t chunk;
+    std::memcpy(&chunk, p, sizeof(chunk));
+    return chunk;
+}
+
+// Number of leading ASCII digits in an eight byte little-endian chunk. A
+// byte is a digit if its high nibble is 3 and adding 6 does not carry into
+// the high nibble; borrows only propagate upwards, so the lowest flagged
+// byte is always exact.
+static unsigned int DigitCount(std::uint64_t chunk) noexcept
+{
+    const std::uint64_t nonDigits = ((chunk & 0xF0F0F0F0F0F0F0F0) - 0x3030303030303030)
+                                    | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) - 0x3030303030303030);
+    return nonDigits == 0 ? 8 : static_cast<unsigned int>(__builtin_ctzll(nonDigits)) / 8;
+}
+
+// Value of the first count (1 to 8) digits of a chunk. Shifting the digits
+// to the top of the word turns the vacated low bytes into leading zeros,
+// then pairs, quads and octets of digits are combined with one multiply
+// each.
+static std::uint64_t ParseDigits(std::uint64_t chunk, unsigned int count) noexcept
+{
+    chunk <<= 8 * (8 - count);
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    return ((chunk & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+static const char* ParseUnsigned(const char* p, std::uint64_t& value, unsigned int& digits) noexcept
+{
+    value = 0;
+    digits = 0;
+    for (;;)
+    {
+        const std::uint64_t chunk = LoadEight(p);
+        const unsigned int count = DigitCount(chunk);
+        if (count == 0)
+        {
+            return p;
+        }
+        value = value * POWERS_OF_TEN[count] + ParseDigits(chunk, count);
+        p += count;
+        digits += count;
+        if (count < 8)
+        {
+            return p;
+        }
+    }
+}
+
+static const char* ParseUnsigned(const char* p, unsigned long& value) noexcept
+{
+    std::uint64_t parsed;
+    unsigned int digits;
+    p = ParseUnsigned(p, parsed, digits);
+    value = parsed;
+    return p;
+}
+
+static const char* SkipField(const char* p, const char* end) noexcept
+{
+    const void* comma = std::memchr(p, ',', static_cast<std::size_t>(end - p));
+    return comma != nullptr ? static_cast<const char*>(comma) + 1 : end;
+}
+
+// Parse one data line starting at p; returns the start of the next line.
+static const char* ParseRow(const char* p, const char* end, MarketDataRow& row, bool& valid) noexcept
+{
+    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    if (lineEnd == nullptr)
+    {
+        lineEnd = end;
+    }
+    valid = false;
+
+    std::uint64_t seconds = 0;
+    std::uint64_t fraction = 0;
+    unsigned int digits = 0;
+    p = ParseUnsigned(p, seconds, digits);
+    if (digits == 0)
+    {
+        return lineEnd + 1;
+    }
+    if (*p == '.')
+    {
+        p = ParseUnsigned(p + 1, fraction, digits);
+        while (digits > 9)
+        {
+            fraction /= 10;
+            --digits;
+        }
+        fraction *= POWERS_OF_TEN[9 - digits];
+    }
+    row.time = static_cast<std::int64_t>(seconds * NANOSECONDS_PER_SECOND + fraction);
+
+    p = SkipField(p, lineEnd);
+    row.instrument = (*p == '1') ? Instrument::ETF : Instrument::FUTURE;
+    p = SkipField(p, lineEnd);
+
+    switch (*p)
+    {
+    case 'I':
+        row.operation = Operation::INSERT;
+        break;
+    case 'C':
+        row.operation = Operation::CANCEL;
+        break;
+    case 'A':
+        row.operation = Operation::AMEND;
+        break;
+    default:
+        return lineEnd + 1;
+    }
+    p = SkipField(p, lineEnd);
+
+    p = SkipField(ParseUnsigned(p, row.orderId), lineEnd);
+    row.side = (*p == 'A' || *p == 'S') ? Side::SELL : Side::BUY;
+    p = SkipField(p, lineEnd);
+    p = SkipField(ParseUnsigned(p, row.volume), lineEnd);
+    p = SkipField(ParseUnsigned(p, row.price), lineEnd);
+    row.lifespan = (*p == 'F') ? Lifespan::FILL_AND_KILL : Lifespan::GOOD_FOR_DAY;
+
+    valid = true;
+    return lineEnd + 1;
+}
+
+static void ParseChunk(const char* begin, const char* end, std::vector<MarketDataRow>& rows)
+{
+    rows.reserve(static_cast<std::size_t>(end - begin) / 32);
+    MarketDataRow row{};
+    bool valid;
+    for (const char* p = begin; p < end;)
+    {
+        p = ParseRow(p, end, row, valid);
+        if (valid)
+        {
+            rows.push_back(row);
+        }
+    }
+}
+
+// Replays market data rows through an order book per instrument and writes
+// periodic book snapshots and trade ticks to a journal.
+class SessionBuilder
+{
+public:
+    SessionBuilder(JournalFileWriter& writer, std::chrono::nanoseconds interval)
+        : mWriter(writer), mInterval(interval.count()), mNextPublish(interval.count())
+    {
+    }
+
+    void Apply(const MarketDataRow& row)
+    {
+        while (row.time >= mNextPublish)
+        {
+            Publish(mNextPublish);
+            mNextPublish += mInterval;
+        }
+
+        const auto index = static_cast<std::size_t>(row.instrument);
+        OrderBook& book = mBooks[index];
+        switch (row.operation)
+        {
+        case Operation::INSERT:
+            mTrades.clear();
+            book.Insert(row.orderId, row.side, row.price, row.volume, row.lifespan, mTrades);
+            for (const BookTrade& trade : mTrades)
+            {
+                // Buyers lift asks and sellers hit bids.
+                auto& ticks = (trade.aggressorSide == Side::BUY) ? mAskTicks[index] : mBidTicks[index];
+                ticks[trade.price] += trade.volume;
+            }
+            break;
+        case Operation::CANCEL:
+            book.Cancel(row.orderId);
+            break;
+        case Operation::AMEND:
+            book.Amend(row.orderId, row.volume);
+            break;
+        }
+    }
+
+    void Finish()
+    {
+        Publish(mNextPublish);
+    }
+
+    unsigned long Records() const { return mRecords; }
+
+private:
+    void Publish(std::int64_t time)
+    {
+        for (Instrument instrument : {Instrument::FUTURE, Instrument::ETF})
+        {
+            const auto index = static_cast<std::size_t>(instrument);
+            JournalRecord record;
+            record.type = JournalRecordType::ORDER_BOOK;
+            record.instrument = instrument;
+            record.timestamp = time;
+            record.sequenceNumber = ++mSequenceNumbers[index];
+            mBooks[index].TopLevels(record.askPrices, record.askVolumes, record.bidPrices, record.bidVolumes);
+            mWriter.Append(record);
+            ++mRecords;
+
+            if (mAskTicks[index].empty() && mBidTicks[index].empty())
+            {
+                continue;
+            }
+
+            record = JournalRecord();
+            record.type = JournalRecordType::TRADE_TICKS;
+            record.instrument = instrument;
+            record.timestamp = time;
+            record.sequenceNumber = mSequenceNumbers[index];
+            int i = 0;
+            for (auto it = mAskTicks[index].begin(); it != mAskTicks[index].end() && i < TOP_LEVEL_COUNT; ++it, ++i)
+            {
+                record.askPrices[i] = it->first;
+                record.askVolumes[i] = it->second;
+            }
+            i = 0;
+            for (auto it = mBidTicks[index].rbegin(); it != mBidTicks[index].rend() && i < TOP_LEVEL_COUNT; ++it, ++i)
+            {
+                record.bidPrices[i] = it->first;
+                record.bidVolumes[i] = it->second;
+            }
+            mWriter.Append(record);
+            ++mRecords;
+            mAskTicks[index].clear();
+            mBidTicks[index].clear();
+        }
+    }
+
+    JournalFileWriter& mWriter;
+    std::int64_t mInterval;
+    std::int64_t mNextPublish;
+    std::array<OrderBook, 2> mBooks;
+    std::array<std::map<unsigned long, unsigned long>, 2> mAskTicks;
+    std::array<std::map<unsigned long, unsigned long>, 2> mBidTicks;
+    std::array<unsigned long, 2> mSequenceNumbers{};
+    std::vector<BookTrade> mTrades;
+    unsigned long mRecords = 0;
+};
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "usage: " << argv[0] << " <market data csv> <output journal> [book interval ms]" << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::chrono::nanoseconds interval = (argc == 4) ? std::chrono::milliseconds(std::atol(argv[3]))
+                                                          : DEFAULT_BOOK_INTERVAL;
+
+    std::FILE* file = std::fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::fseek(file, 0, SEEK_END);
+    const auto size = static_cast<std::size_t>(std::ftell(file));
+    std::fseek(file, 0, SEEK_SET);
+
+    // Zero padding lets the parser load eight bytes past any position.
+    std::vector<char> data(size + CSV_PADDING, '\0');
+    const std::size_t read = std::fread(data.data(), 1, size, file);
+    std::fclose(file);
+    if (read != size)
+    {
+        std::cerr << "cannot read " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const char* begin = data.data();
+    const char* end = begin + size;
+    if (size != 0 && (*begin < '0' || *begin > '9'))
+    {
+        const void* newline = std::memchr(begin, '\n', size);
+        begin = (newline != nullptr) ? static_cast<const char*>(newline) + 1 : end;
+    }
+
+    // Split into roughly equal chunks, each ending just after a newline.
+    const std::size_t chunkCount = std::max<std::size_t>(
+            1, std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()) * 4,
+                                     static_cast<std::size_t>(end - begin) / MIN_CHUNK_SIZE));
+    std::vector<const char*> boundaries{begin};
+    for (std::size_t i = 1; i < chunkCount; ++i)
+    {
+        const char* p = std::max(begin + static_cast<std::size_t>(end - begin) * i / chunkCount, boundaries.back());
+        const void* newline = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+        boundaries.push_back(newline != nullptr ? static_cast<const char*>(newline) + 1 : end);
+    }
+    boundaries.push_back(end);
+
+    std::vector<std::vector<MarketDataRow>> chunks(chunkCount);
+    ParallelFor(chunkCount, [&](std::size_t i) { ParseChunk(boundaries[i], boundaries[i + 1], chunks[i]); });
+
+    const auto parsed = std::chrono::steady_clock::now();
+
+    JournalFileWriter writer;
+    std::string error;
+    if (!writer.Open(argv[2], error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    SessionBuilder builder(writer, interval);
+    unsigned long rowCount = 0;
+    for (const auto& chunk : chunks)
+    {
+        for (const MarketDataRow& row : chunk)
+        {
+            builder.Apply(row);
+        }
+        rowCount += chunk.size();
+    }
+    builder.Finish();
+    if (!writer.Close())
+    {
+        std::cerr << "cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    const auto finished = std::chrono::steady_clock::now();
+    const double parseSeconds = std::chrono::duration<double>(parsed - start).count();
+    const double totalSeconds = std::chrono::duration<double>(finished - start).count();
+    std::cout << "parsed " << rowCount << " rows (" << size / 1048576.0 / parseSeconds << " MB/s), wrote "
+              << builder.Records() << " journal records in " << totalSeconds << "s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <istream>
+#include <string>
+
+#include "driventrader.h"
+
+using namespace ReadyTraderGo;
+
+DrivenTrader::DrivenTrader(const QuoteParameters& parameters)
+{
+    mConfig.quoteParameters = parameters;
+    mConfig.journalDirectory.clear();
+    mConfig.traceDirectory.clear();
+    mConfig.warmStateFilename.clear();
+    mConfig.eventClock = &mNow;
+    mTrader = std::make_unique<AutoTrader>(mContext, mConfig);
+}
+
+void DrivenTrader::Apply(const JournalRecord& record)
+{
+    mNow = std::chrono::nanoseconds(record.timestamp);
+    switch (record.type)
+    {
+    case JournalRecordType::ORDER_BOOK:
+        mTrader->OrderBookMessageHandler(record.instrument, record.sequenceNumber, record.askPrices,
+                                         record.askVolumes, record.bidPrices, record.bidVolumes);
+        break;
+    case JournalRecordType::TRADE_TICKS:
+        mTrader->TradeTicksMessageHandler(record.instrument, record.sequenceNumber, record.askPrices,
+                                          record.askVolumes, record.bidPrices, record.bidVolumes);
+        break;
+    case JournalRecordType::ORDER_FILLED:
+        mTrader->OrderFilledMessageHandler(record.clientOrderId, record.price, record.volume);
+        break;
+    case JournalRecordType::ORDER_STATUS:
+        mTrader->OrderStatusMessageHandler(record.clientOrderId, record.volume, record.remainingVolume,
+                                           record.fees);
+        break;
+    case JournalRecordType::HEDGE_FILLED:
+        mTrader->HedgeFilledMessageHandler(record.clientOrderId, record.price, record.volume);
+        break;
+    case JournalRecordType::ERROR:
+        mTrader->ErrorMessageHandler(record.clientOrderId, std::string());
+        break;
+    default:
+        break;
+    }
+}
+
+bool DrivenTrader::Restore(std::istream& stream)
+{
+    // The old trader goes first, so that its analytics thread has stopped
+    // before the new one starts.
+    mTrader.reset();
+    mTrader = std::make_unique<AutoTrader>(mContext, mConfig);
+    return mTrader->LoadState(stream);
+}
@@ -0,0 +1,76 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_DRIVENTRADER_H
+#define CPPREADY_TRADER_GO_TOOLS_DRIVENTRADER_H
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <ready_trader_go/baseautotrader.h>
+
+#include "autotrader.h"
+#include "journal.h"
+#include "quotekernel.h"
+
+// The competition AutoTrader driven by a replay or a simulation instead of
+// the exchange. It is built against the send-capturing BaseAutoTrader in
+// tools/rtgdouble, so its sends are collected for the driver. Its handlers
+// take the event time the driver sets rather than the steady clock. It
+// writes no journal, audit trail, traces or warm state, and loads
+// signal_model.bin from the working directory as the live trader does.
+//
+// Tools built on this put tools/rtgdouble on the include path ahead of the
+// RTG library and link the AutoTrader's sources, as handlerbench does.
+class DrivenTrader
+{
+public:
+    explicit DrivenTrader(const QuoteParameters& parameters);
+
+    DrivenTrader(const DrivenTrader&) = delete;
+    DrivenTrader& operator=(const DrivenTrader&) = delete;
+
+    // The event time for the handlers called next.
+    void SetTime(std::chrono::nanoseconds now) { mNow = now; }
+
+    // Deliver an inbound journal record at its timestamp. Records of the
+    // trader's own sends are ignored, and so are disconnects, which end
+    // the session.
+    void Apply(const JournalRecord& record);
+
+    // Replace the trader with a new one restored from the state written by
+    // AutoTrader::SaveState. Returns false if the state cannot be read.
+    bool Restore(std::istream& stream);
+
+    AutoTrader& Trader() { return *mTrader; }
+    const AutoTrader& Trader() const { return *mTrader; }
+
+    // The messages sent since the driver last cleared them.
+    std::vector<ReadyTraderGo::SentMessage>& Sent() { return mTrader->Sent(); }
+
+private:
+    boost::asio::io_context mContext;
+    AutoTraderConfig mConfig;
+    std::chrono::nanoseconds mNow{0};
+    std::unique_ptr<AutoTrader> mTrader;
+};
+
+#endif //CPPREADY_TRADER_GO_TOOLS_DRIVENTRADER_H
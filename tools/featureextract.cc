@@ -0,0 +1,162 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "columnar.h"
+#include "journal.h"
+#include "signalfeatures.h"
+#include "parallel.h"
+
+using namespace ReadyTraderGo;
+
+// Computes signal model features from a directory of session journals and
+// writes them, with a forward-looking ETF mid price label, to a columnar
+// file for offline training.
+//
+// A row is produced for each order book message once both books are
+// two-sided, using exactly the SignalFeatures code that the AutoTrader
+// runs live.
+
+constexpr std::chrono::milliseconds DEFAULT_LABEL_HORIZON{1000};
+
+struct SessionFeatures
+{
+    std::vector<std::int64_t> timestamps;
+    std::vector<float> etfMids;
+    std::vector<FeatureVector> rows;
+    std::vector<float> labels;
+    std::string error;
+};
+
+static void ExtractSession(const std::string& filename, std::chrono::nanoseconds horizon, SessionFeatures& session)
+{
+    std::vector<JournalRecord> records;
+    if (!ReadJournal(filename, records, session.error))
+    {
+        return;
+    }
+
+    SignalFeatures features;
+    for (const JournalRecord& record : records)
+    {
+        if (record.type == JournalRecordType::TRADE_TICKS)
+        {
+            features.TradeTicks(record.instrument, record.askVolumes, record.bidVolumes);
+        }
+        else if (record.type == JournalRecordType::ORDER_BOOK)
+        {
+            features.OrderBook(record.instrument, record.askPrices, record.askVolumes, record.bidPrices,
+                               record.bidVolumes);
+            if (features.Valid())
+            {
+                session.rows.emplace_back();
+                features.Compute(session.rows.back());
+                session.timestamps.push_back(record.timestamp);
+                session.etfMids.push_back(features.Mid(Instrument::ETF));
+            }
+        }
+    }
+
+    // Label each row with the ETF mid change, in ticks, at the first row at
+    // least one horizon later; rows too close to the end get NaN.
+    session.labels.assign(session.rows.size(), std::numeric_limits<float>::quiet_NaN());
+    std::size_t ahead = 0;
+    for (std::size_t i = 0; i < session.rows.size(); ++i)
+    {
+        while (ahead < session.rows.size() && session.timestamps[ahead] - session.timestamps[i] < horizon.count())
+        {
+            ++ahead;
+        }
+        if (ahead == session.rows.size())
+        {
+            break;
+        }
+        session.labels[i] = (session.etfMids[ahead] - session.etfMids[i]) / FEATURE_TICK_SIZE;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal directory> <output file> [label horizon ms]" << std::endl;
+        return 1;
+    }
+
+    const std::chrono::nanoseconds horizon = (argc == 4) ? std::chrono::milliseconds(std::atol(argv[3]))
+                                                         : DEFAULT_LABEL_HORIZON;
+    const std::vector<std::string> journals = ListJournals(argv[1]);
+    if (journals.empty())
+    {
+        std::cerr << "no journals found in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<SessionFeatures> sessions(journals.size());
+    ParallelFor(journals.size(), [&](std::size_t i) { ExtractSession(journals[i], horizon, sessions[i]); });
+
+    std::vector<std::uint32_t> sessionColumn;
+    std::vector<std::int64_t> timestampColumn;
+    std::vector<float> labelColumn;
+    std::vector<std::vector<float>> featureColumns(FEATURE_COUNT);
+    for (std::size_t s = 0; s < sessions.size(); ++s)
+    {
+        const SessionFeatures& session = sessions[s];
+        if (!session.error.empty())
+        {
+            std::cerr << "skipping " << journals[s] << ": " << session.error << std::endl;
+            continue;
+        }
+        sessionColumn.insert(sessionColumn.end(), session.rows.size(), static_cast<std::uint32_t>(s));
+        timestampColumn.insert(timestampColumn.end(), session.timestamps.begin(), session.timestamps.end());
+        labelColumn.insert(labelColumn.end(), session.labels.begin(), session.labels.end());
+        for (const FeatureVector& row : session.rows)
+        {
+            for (std::size_t f = 0; f < FEATURE_COUNT; ++f)
+            {
+                featureColumns[f].push_back(row[f]);
+            }
+        }
+    }
+
+    ColumnarWriter writer;
+    writer.AddColumn("session", sessionColumn);
+    writer.AddColumn("timestamp", timestampColumn);
+    for (std::size_t f = 0; f < FEATURE_COUNT; ++f)
+    {
+        writer.AddColumn(FEATURE_NAMES[f], featureColumns[f]);
+    }
+    writer.AddColumn("label_etf_mid_change", labelColumn);
+
+    std::string error;
+    if (!writer.Write(argv[2], error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::cout << "wrote " << labelColumn.size() << " rows from " << journals.size() << " journals to " << argv[2]
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "columnar.h"
+
+// Reports the fill rate of our ETF orders by limit price across one or more
+// columnar exports, reading the mapped order and fill columns directly.
+
+struct PriceLevelStats
+{
+    unsigned long orders = 0;
+    unsigned long insertedVolume = 0;
+    unsigned long filledVolume = 0;
+};
+
+static bool Accumulate(const std::string& filename, std::map<std::uint64_t, PriceLevelStats>& levels,
+                       std::string& error)
+{
+    ColumnarFile file;
+    if (!file.Open(filename, error))
+    {
+        return false;
+    }
+
+    std::size_t orderCount = 0;
+    std::size_t fillCount = 0;
+    std::size_t rows = 0;
+    const auto* orderIds = file.Column<std::uint64_t>("orders.client_order_id", orderCount);
+    const auto* orderPrices = file.Column<std::uint64_t>("orders.price", rows);
+    const auto* orderVolumes = file.Column<std::uint64_t>("orders.volume", rows);
+    const auto* fillIds = file.Column<std::uint64_t>("fills.client_order_id", fillCount);
+    const auto* fillVolumes = file.Column<std::uint64_t>("fills.volume", rows);
+    if (orderIds == nullptr || orderPrices == nullptr || orderVolumes == nullptr || fillIds == nullptr
+        || fillVolumes == nullptr)
+    {
+        error = filename + " is missing order or fill columns";
+        return false;
+    }
+
+    std::unordered_map<std::uint64_t, std::uint64_t> orderPrice;
+    orderPrice.reserve(orderCount);
+    for (std::size_t i = 0; i < orderCount; ++i)
+    {
+        orderPrice.emplace(orderIds[i], orderPrices[i]);
+        PriceLevelStats& level = levels[orderPrices[i]];
+        level.orders += 1;
+        level.insertedVolume += orderVolumes[i];
+    }
+
+    for (std::size_t i = 0; i < fillCount; ++i)
+    {
+        auto it = orderPrice.find(fillIds[i]);
+        if (it != orderPrice.end())
+        {
+            levels[it->second].filledVolume += fillVolumes[i];
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <columnar file>..." << std::endl;
+        return 1;
+    }
+
+    std::map<std::uint64_t, PriceLevelStats> levels;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string error;
+        if (!Accumulate(argv[i], levels, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::setw(10) << "price" << std::setw(10) << "orders" << std::setw(12) << "inserted"
+              << std::setw(12) << "filled" << std::setw(10) << "rate" << '\n';
+    for (const auto& [price, level] : levels)
+    {
+        const double rate = level.insertedVolume != 0
+                            ? static_cast<double>(level.filledVolume) / static_cast<double>(level.insertedVolume)
+                            : 0.0;
+        std::cout << std::setw(10) << price << std::setw(10) << level.orders << std::setw(12)
+                  << level.insertedVolume << std::setw(12) << level.filledVolume << std::setw(10)
+                  << std::fixed << std::setprecision(3) << rate << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "autotrader.h"
+#include "benchstore.h"
+#include "journal.h"
+#include "orderworkflow.h"
+
+using namespace ReadyTraderGo;
+
+// Benchmarks the trader's message handlers and replay throughput over a
+// journal corpus and appends the samples to the results store under the
+// given commit.
+//
+// The handlers measured are AutoTrader's own, built against the
+// send-capturing BaseAutoTrader in tools/rtgdouble, so every cost of the
+// live path is counted: journal, audit and analytics pushes, tracing and
+// coroutine workflow frames. As live, the journal, audit trail and tracer
+// are enabled by their directories in the working directory. Message
+// pacing follows the wall clock, so a replay at full speed may quote less
+// than the recorded session did. Each run replays every journal twice:
+// once timing each handler call, and once untimed for throughput, so the
+// clock reads do not count against it.
+
+constexpr int DEFAULT_RUNS = 15;
+constexpr char DEFAULT_STORE[] = "benchmarks";
+
+using Clock = std::chrono::steady_clock;
+
+struct HandlerTiming
+{
+    double nanoseconds = 0.0;
+    unsigned long calls = 0;
+
+    void Add(Clock::time_point start)
+    {
+        nanoseconds += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        ++calls;
+    }
+};
+
+// Feed one inbound record to the trader. Returns false for records that
+// no handler acts on. Disconnects are not replayed: they end the session.
+static bool Dispatch(AutoTrader& trader, const JournalRecord& record)
+{
+    switch (record.type)
+    {
+    case JournalRecordType::ORDER_BOOK:
+        trader.OrderBookMessageHandler(record.instrument, record.sequenceNumber, record.askPrices,
+                                       record.askVolumes, record.bidPrices, record.bidVolumes);
+        return true;
+    case JournalRecordType::TRADE_TICKS:
+        trader.TradeTicksMessageHandler(record.instrument, record.sequenceNumber, record.askPrices,
+                                        record.askVolumes, record.bidPrices, record.bidVolumes);
+        return true;
+    case JournalRecordType::ORDER_FILLED:
+        trader.OrderFilledMessageHandler(record.clientOrderId, record.price, record.volume);
+        return true;
+    case JournalRecordType::ORDER_STATUS:
+        trader.OrderStatusMessageHandler(record.clientOrderId, record.volume, record.remainingVolume, record.fees);
+        return true;
+    case JournalRecordType::HEDGE_FILLED:
+        trader.HedgeFilledMessageHandler(record.clientOrderId, record.price, record.volume);
+        return true;
+    case JournalRecordType::ERROR:
+        trader.ErrorMessageHandler(record.clientOrderId, std::string());
+        return true;
+    default:
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 5)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal file or directory> <commit> [runs] [results directory]"
+                  << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path input(argv[1]);
+    const std::string commit = argv[2];
+    const int runs = (argc > 3) ? std::atoi(argv[3]) : DEFAULT_RUNS;
+    const std::string store = (argc > 4) ? argv[4] : DEFAULT_STORE;
+
+    std::vector<std::vector<JournalRecord>> journals;
+    const std::vector<std::string> filenames = std::filesystem::is_directory(input)
+                                               ? ListJournals(input.string())
+                                               : std::vector<std::string>{input.string()};
+    for (const std::string& filename : filenames)
+    {
+        std::string error;
+        journals.emplace_back();
+        if (!ReadJournal(filename, journals.back(), error))
+        {
+            std::cerr << "skipping " << error << std::endl;
+            journals.pop_back();
+        }
+    }
+    if (journals.empty() || runs <= 0)
+    {
+        std::cerr << "nothing to benchmark" << std::endl;
+        return 1;
+    }
+
+    boost::asio::io_context context;
+    BenchmarkSamples samples;
+    unsigned long sent = 0;
+    for (int run = 0; run < runs; ++run)
+    {
+        HandlerTiming orderBook;
+        HandlerTiming tradeTicks;
+        HandlerTiming orderFilled;
+        HandlerTiming orderStatus;
+        HandlerTiming hedgeFilled;
+        for (const std::vector<JournalRecord>& records : journals)
+        {
+            const auto trader = std::make_unique<AutoTrader>(context);
+            for (const JournalRecord& record : records)
+            {
+                const Clock::time_point start = Clock::now();
+                if (!Dispatch(*trader, record))
+                {
+                    continue;
+                }
+                switch (record.type)
+                {
+                case JournalRecordType::ORDER_BOOK:
+                    orderBook.Add(start);
+                    break;
+                case JournalRecordType::TRADE_TICKS:
+                    tradeTicks.Add(start);
+                    break;
+                case JournalRecordType::ORDER_FILLED:
+                    orderFilled.Add(start);
+                    break;
+                case JournalRecordType::ORDER_STATUS:
+                    orderStatus.Add(start);
+                    break;
+                case JournalRecordType::HEDGE_FILLED:
+                    hedgeFilled.Add(start);
+                    break;
+                default:
+                    break;
+                }
+                trader->Sent().clear();
+            }
+            if (run == 0)
+            {
+                sent += trader->SentMessages();
+            }
+        }
+
+        unsigned long events = 0;
+        const Clock::time_point start = Clock::now();
+        for (const std::vector<JournalRecord>& records : journals)
+        {
+            const auto trader = std::make_unique<AutoTrader>(context);
+            for (const JournalRecord& record : records)
+            {
+                events += Dispatch(*trader, record) ? 1 : 0;
+                trader->Sent().clear();
+            }
+        }
+        const double replay = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        for (const auto& [name, timing] : {std::make_pair("order_book.ns", orderBook),
+                                           std::make_pair("trade_ticks.ns", tradeTicks),
+                                           std::make_pair("order_filled.ns", orderFilled),
+                                           std::make_pair("order_status.ns", orderStatus),
+                                           std::make_pair("hedge_filled.ns", hedgeFilled)})
+        {
+            if (timing.calls != 0)
+            {
+                samples[name].push_back(timing.nanoseconds / static_cast<double>(timing.calls));
+            }
+        }
+        if (events != 0)
+        {
+            samples["replay.ns_per_event"].push_back(replay / static_cast<double>(events));
+        }
+    }
+
+    std::string error;
+    if (!AppendBenchmarkSamples(store, commit, samples, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    for (const auto& [name, values] : samples)
+    {
+        double total = 0.0;
+        for (double value : values)
+        {
+            total += value;
+        }
+        std::cout << name << ": mean " << total / static_cast<double>(values.size()) << " over "
+                  << values.size() << " runs" << std::endl;
+    }
+    std::cout << "messages sent in the first run: " << sent << std::endl;
+    std::cout << "workflow frames allocated from the heap: " << WorkflowFramePool::Local().HeapFallbacks()
+              << std::endl;
+    return 0;
+}
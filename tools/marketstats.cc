@@ -0,0 +1,128 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <array>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "journal.h"
+#include "marketstats.h"
+#include "parallel.h"
+
+using namespace ReadyTraderGo;
+
+// Quantiles of spread, basis, fill edge and fill size across a corpus of
+// journals, gathered with the same sketches as the live analytics. Each
+// journal is summarised on a worker thread and merged into the total, so
+// memory does not grow with the corpus.
+
+constexpr std::array<double, 7> REPORT_QUANTILES = {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+
+static bool Accumulate(const std::string& filename, MarketStats& stats, std::string& error)
+{
+    std::vector<JournalRecord> records;
+    if (!ReadJournal(filename, records, error))
+    {
+        return false;
+    }
+
+    // Fills carry only the order id; the side comes from our insert.
+    std::unordered_map<unsigned long, Side> sides;
+    for (const JournalRecord& record : records)
+    {
+        switch (record.type)
+        {
+        case JournalRecordType::ORDER_BOOK:
+            stats.OrderBook(record.instrument, record.askPrices[0], record.bidPrices[0]);
+            break;
+        case JournalRecordType::INSERT_ORDER:
+            sides[record.clientOrderId] = record.side;
+            break;
+        case JournalRecordType::ORDER_FILLED:
+        {
+            auto it = sides.find(record.clientOrderId);
+            if (it != sides.end())
+            {
+                stats.Filled(it->second, record.price, record.volume);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal file or directory>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> journals;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::vector<std::string> found = std::filesystem::is_directory(argv[i])
+                                               ? ListJournals(argv[i])
+                                               : std::vector<std::string>{argv[i]};
+        journals.insert(journals.end(), found.begin(), found.end());
+    }
+
+    auto total = std::make_unique<MarketStats>();
+    std::mutex totalMutex;
+    ParallelFor(journals.size(), [&](std::size_t i) {
+        auto stats = std::make_unique<MarketStats>();
+        std::string error;
+        if (!Accumulate(journals[i], *stats, error))
+        {
+            std::lock_guard<std::mutex> lock(totalMutex);
+            std::cerr << "skipping " << error << std::endl;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(totalMutex);
+        total->Merge(*stats);
+    });
+
+    std::cout << std::left << std::setw(16) << "stat" << std::right << std::setw(12) << "count";
+    for (double q : REPORT_QUANTILES)
+    {
+        std::cout << std::setw(10) << ("p" + std::to_string(static_cast<int>(q * 100)));
+    }
+    std::cout << '\n' << std::fixed << std::setprecision(1);
+    for (std::size_t i = 0; i < MARKET_STAT_COUNT; ++i)
+    {
+        const auto stat = static_cast<MarketStat>(i);
+        QuantileSketch& sketch = (*total)[stat];
+        std::cout << std::left << std::setw(16) << MarketStatName(stat) << std::right << std::setw(12)
+                  << static_cast<unsigned long>(sketch.Count());
+        for (double q : REPORT_QUANTILES)
+        {
+            std::cout << std::setw(10) << sketch.Quantile(q);
+        }
+        std::cout << '\n';
+    }
+    return 0;
+}
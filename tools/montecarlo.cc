@@ -0,0 +1,164 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "parallel.h"
+#include "simulator.h"
+
+// Runs many randomised synthetic sessions of the AutoTrader against the
+// simulated exchange on every core and summarises how the strategy holds
+// up. The trader is the competition AutoTrader driven through
+// tools/rtgdouble, so this is built as handlerbench is, and it uses the
+// signal model in the working directory if there is one.
+//
+// Each session draws its volatility, basis noise, latency and fill rate
+// from its own seed, so any session in the report can be rerun alone.
+
+constexpr signed long TICK_SIZE_IN_CENTS = 100;
+
+static SessionConfig DrawConfig(unsigned long seed, const QuoteParameters& parameters)
+{
+    std::mt19937_64 random(seed);
+    auto uniform = [&](double low, double high) { return std::uniform_real_distribution<double>(low, high)(random); };
+
+    SessionConfig config;
+    config.seed = seed;
+    config.volatility = uniform(0.0001, 0.002);
+    config.basisNoise = uniform(20.0, 300.0);
+    config.basisReversion = uniform(0.1, 2.0);
+    config.latencySeconds = uniform(0.0005, 0.3);
+    config.fillRate = uniform(0.02, 1.0);
+    config.parameters = parameters;
+    return config;
+}
+
+static double Percentile(const std::vector<signed long>& sorted, double fraction)
+{
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[index]);
+}
+
+static void PrintSessions(const char* label, unsigned long count, std::size_t total)
+{
+    std::cout << std::setw(28) << std::left << label << count << " sessions ("
+              << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(count) / static_cast<double>(total)
+              << "%)\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 7)
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " <sessions> [first seed] [min edge ticks] [position limit] [lot size] [per-session csv]"
+                  << std::endl;
+        return 1;
+    }
+
+    const std::size_t sessions = std::strtoul(argv[1], nullptr, 10);
+    const unsigned long firstSeed = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 1;
+    QuoteParameters parameters;
+    if (argc > 3)
+    {
+        parameters.minEdge = std::atol(argv[3]) * TICK_SIZE_IN_CENTS;
+    }
+    if (argc > 4)
+    {
+        parameters.positionLimit = std::atol(argv[4]);
+    }
+    if (argc > 5)
+    {
+        parameters.lotSize = std::atol(argv[5]);
+    }
+    if (sessions == 0)
+    {
+        std::cerr << "no sessions to run" << std::endl;
+        return 1;
+    }
+
+    std::vector<SessionConfig> configs(sessions);
+    std::vector<SessionResult> results(sessions);
+    ParallelFor(sessions, [&](std::size_t i) {
+        configs[i] = DrawConfig(firstSeed + i, parameters);
+        results[i] = RunSession(configs[i]);
+    });
+
+    if (argc > 6)
+    {
+        std::ofstream csv(argv[6]);
+        csv << "seed,volatility,basis_noise,basis_reversion,latency,fill_rate,pnl,max_position,max_unhedged,"
+               "etf_volume,messages,message_limit_breaches,position_limit_breaches,hedge_deadline_breaches,"
+               "failed_hedges\n";
+        for (std::size_t i = 0; i < sessions; ++i)
+        {
+            const SessionConfig& c = configs[i];
+            const SessionResult& r = results[i];
+            csv << c.seed << ',' << c.volatility << ',' << c.basisNoise << ',' << c.basisReversion << ','
+                << c.latencySeconds << ',' << c.fillRate << ',' << r.profitLoss << ',' << r.maxPosition << ','
+                << r.maxUnhedged << ',' << r.etfVolume << ',' << r.messages << ',' << r.messageLimitBreaches << ','
+                << r.positionLimitBreaches << ',' << r.hedgeDeadlineBreaches << ',' << r.failedHedges << '\n';
+        }
+    }
+
+    std::vector<signed long> pnl(sessions);
+    std::vector<signed long> maxPosition(sessions);
+    unsigned long messageBreaches = 0;
+    unsigned long positionBreaches = 0;
+    unsigned long hedgeBreaches = 0;
+    for (std::size_t i = 0; i < sessions; ++i)
+    {
+        pnl[i] = results[i].profitLoss;
+        maxPosition[i] = results[i].maxPosition;
+        messageBreaches += results[i].messageLimitBreaches != 0 ? 1 : 0;
+        positionBreaches += results[i].positionLimitBreaches != 0 ? 1 : 0;
+        hedgeBreaches += results[i].hedgeDeadlineBreaches != 0 ? 1 : 0;
+    }
+
+    const double mean = std::accumulate(pnl.begin(), pnl.end(), 0.0) / static_cast<double>(sessions);
+    double variance = 0.0;
+    for (signed long value : pnl)
+    {
+        variance += (static_cast<double>(value) - mean) * (static_cast<double>(value) - mean);
+    }
+    const double stddev = std::sqrt(variance / static_cast<double>(sessions));
+    const std::size_t worst = std::min_element(pnl.begin(), pnl.end()) - pnl.begin();
+    std::sort(pnl.begin(), pnl.end());
+    std::sort(maxPosition.begin(), maxPosition.end());
+
+    std::cout << sessions << " sessions, seeds " << firstSeed << " to " << firstSeed + sessions - 1 << "\n"
+              << std::fixed << std::setprecision(0)
+              << "pnl (cents)     mean " << mean << "  stddev " << stddev
+              << "  p1 " << Percentile(pnl, 0.01) << "  p5 " << Percentile(pnl, 0.05)
+              << "  p50 " << Percentile(pnl, 0.5) << "  p95 " << Percentile(pnl, 0.95)
+              << "  p99 " << Percentile(pnl, 0.99) << "\n"
+              << "max position    p50 " << Percentile(maxPosition, 0.5) << "  p99 " << Percentile(maxPosition, 0.99)
+              << "  max " << maxPosition.back() << "\n";
+    PrintSessions("message limit breaches", messageBreaches, sessions);
+    PrintSessions("position limit breaches", positionBreaches, sessions);
+    PrintSessions("hedge deadline breaches", hedgeBreaches, sessions);
+    std::cout << "worst session: seed " << configs[worst].seed << " pnl " << results[worst].profitLoss << std::endl;
+    return 0;
+}
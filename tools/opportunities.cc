@@ -0,0 +1,113 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "opportunitytracker.h"
+
+// Summarises the OPPORTUNITY records of one or more journals by the reason
+// each cross was not taken, most valuable first, to show which constraint
+// is worth relaxing first.
+
+struct ReasonStats
+{
+    unsigned long opportunities = 0;
+    unsigned long volume = 0;
+    double value = 0.0; // edge times size, in cents
+    double seconds = 0.0;
+    unsigned long evaluations = 0;
+};
+
+static bool Accumulate(const std::string& filename, std::array<ReasonStats, MISS_REASON_COUNT>& reasons,
+                       std::string& error)
+{
+    std::vector<JournalRecord> records;
+    if (!ReadJournal(filename, records, error))
+    {
+        return false;
+    }
+    for (const JournalRecord& record : records)
+    {
+        if (record.type != JournalRecordType::OPPORTUNITY || record.clientOrderId >= MISS_REASON_COUNT)
+        {
+            continue;
+        }
+        ReasonStats& stats = reasons[record.clientOrderId];
+        stats.opportunities += 1;
+        stats.volume += record.volume;
+        stats.value += static_cast<double>(record.price) * static_cast<double>(record.volume);
+        stats.seconds += static_cast<double>(record.remainingVolume) * 1e-9;
+        stats.evaluations += record.sequenceNumber;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <journal file or directory>..." << std::endl;
+        return 1;
+    }
+
+    std::array<ReasonStats, MISS_REASON_COUNT> reasons{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::vector<std::string> filenames = std::filesystem::is_directory(argv[i])
+                                                   ? ListJournals(argv[i])
+                                                   : std::vector<std::string>{argv[i]};
+        for (const std::string& filename : filenames)
+        {
+            std::string error;
+            if (!Accumulate(filename, reasons, error))
+            {
+                std::cerr << "skipping " << error << std::endl;
+            }
+        }
+    }
+
+    std::array<std::size_t, MISS_REASON_COUNT> order{};
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&reasons](std::size_t a, std::size_t b) {
+        return reasons[a].value > reasons[b].value;
+    });
+
+    std::cout << std::left << std::setw(18) << "reason" << std::right << std::setw(10) << "count"
+              << std::setw(10) << "lots" << std::setw(14) << "value" << std::setw(12) << "mean ms"
+              << std::setw(12) << "mean evals" << '\n';
+    for (std::size_t i : order)
+    {
+        const ReasonStats& stats = reasons[i];
+        const double count = std::max(1.0, static_cast<double>(stats.opportunities));
+        std::cout << std::left << std::setw(18) << MissReasonName(static_cast<MissReason>(i)) << std::right
+                  << std::setw(10) << stats.opportunities << std::setw(10) << stats.volume << std::setw(14)
+                  << std::fixed << std::setprecision(0) << stats.value << std::setw(12) << std::setprecision(1)
+                  << stats.seconds * 1e3 / count << std::setw(12) << static_cast<double>(stats.evaluations) / count
+                  << '\n';
+    }
+    return 0;
+}
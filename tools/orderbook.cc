@@ -0,0 +1,173 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+
+#include "orderbook.h"
+
+using namespace ReadyTraderGo;
+
+template<typename Levels>
+void OrderBook::Match(Levels& levels, unsigned long orderId, Side side, unsigned long price,
+                      unsigned long& remaining, std::vector<BookTrade>& trades)
+{
+    auto comparator = levels.key_comp();
+    while (remaining != 0 && !levels.empty() && !comparator(price, levels.begin()->first))
+    {
+        auto level = levels.begin();
+        while (remaining != 0 && !level->second.queue.empty())
+        {
+            const unsigned long restingId = level->second.queue.front();
+            Order& resting = mOrders[restingId];
+            const unsigned long volume = std::min(remaining, resting.remaining);
+            trades.push_back({orderId, restingId, side, level->first, volume});
+            remaining -= volume;
+            resting.remaining -= volume;
+            resting.filled += volume;
+            level->second.volume -= volume;
+            if (resting.remaining == 0)
+            {
+                level->second.queue.pop_front();
+                mOrders.erase(restingId);
+            }
+        }
+        if (level->second.queue.empty())
+        {
+            levels.erase(level);
+        }
+    }
+}
+
+template<typename Levels>
+void OrderBook::Remove(Levels& levels, unsigned long orderId, const Order& order)
+{
+    auto level = levels.find(order.price);
+    if (level == levels.end())
+    {
+        return;
+    }
+    level->second.volume -= order.remaining;
+    auto& queue = level->second.queue;
+    queue.erase(std::find(queue.begin(), queue.end(), orderId));
+    if (queue.empty())
+    {
+        levels.erase(level);
+    }
+}
+
+unsigned long OrderBook::Insert(unsigned long orderId,
+                                Side side,
+                                unsigned long price,
+                                unsigned long volume,
+                                Lifespan lifespan,
+                                std::vector<BookTrade>& trades)
+{
+    unsigned long remaining = volume;
+    if (side == Side::BUY)
+    {
+        // A buy matches asks priced at or below its limit: asks are ordered
+        // by std::less, so !(price < best) means best <= price.
+        Match(mAsks, orderId, side, price, remaining, trades);
+    }
+    else
+    {
+        Match(mBids, orderId, side, price, remaining, trades);
+    }
+
+    if (remaining == 0 || lifespan == Lifespan::FILL_AND_KILL)
+    {
+        return 0;
+    }
+
+    mOrders[orderId] = {side, price, volume - remaining, remaining};
+    Level& level = (side == Side::BUY) ? mBids[price] : mAsks[price];
+    level.volume += remaining;
+    level.queue.push_back(orderId);
+    return remaining;
+}
+
+bool OrderBook::Amend(unsigned long orderId, unsigned long volume)
+{
+    auto it = mOrders.find(orderId);
+    if (it == mOrders.end())
+    {
+        return false;
+    }
+
+    Order& order = it->second;
+    if (volume <= order.filled)
+    {
+        return Cancel(orderId);
+    }
+
+    const unsigned long remaining = std::min(order.remaining, volume - order.filled);
+    const unsigned long reduction = order.remaining - remaining;
+    order.remaining = remaining;
+    if (order.side == Side::BUY)
+    {
+        mBids[order.price].volume -= reduction;
+    }
+    else
+    {
+        mAsks[order.price].volume -= reduction;
+    }
+    return true;
+}
+
+bool OrderBook::Cancel(unsigned long orderId)
+{
+    auto it = mOrders.find(orderId);
+    if (it == mOrders.end())
+    {
+        return false;
+    }
+
+    if (it->second.side == Side::BUY)
+    {
+        Remove(mBids, orderId, it->second);
+    }
+    else
+    {
+        Remove(mAsks, orderId, it->second);
+    }
+    mOrders.erase(it);
+    return true;
+}
+
+void OrderBook::TopLevels(std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                          std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) const
+{
+    askPrices.fill(0);
+    askVolumes.fill(0);
+    bidPrices.fill(0);
+    bidVolumes.fill(0);
+
+    int i = 0;
+    for (auto it = mAsks.begin(); it != mAsks.end() && i < TOP_LEVEL_COUNT; ++it, ++i)
+    {
+        askPrices[i] = it->first;
+        askVolumes[i] = it->second.volume;
+    }
+    i = 0;
+    for (auto it = mBids.begin(); it != mBids.end() && i < TOP_LEVEL_COUNT; ++it, ++i)
+    {
+        bidPrices[i] = it->first;
+        bidVolumes[i] = it->second.volume;
+    }
+}
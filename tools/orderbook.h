@@ -0,0 +1,101 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_ORDERBOOK_H
+#define CPPREADY_TRADER_GO_TOOLS_ORDERBOOK_H
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+// A trade produced by an aggressive order. Prices are in cents.
+struct BookTrade
+{
+    unsigned long aggressorId;
+    unsigned long restingId;
+    ReadyTraderGo::Side aggressorSide;
+    unsigned long price;
+    unsigned long volume;
+};
+
+// Price-time priority limit order book for one instrument, used by the
+// offline tools to rebuild exchange order books and to simulate matching.
+class OrderBook
+{
+public:
+    // Insert an order, matching it against the opposite side first. Any
+    // trades are appended to trades. Fill-and-kill remainders are dropped.
+    // Returns the volume left resting in the book.
+    unsigned long Insert(unsigned long orderId,
+                         ReadyTraderGo::Side side,
+                         unsigned long price,
+                         unsigned long volume,
+                         ReadyTraderGo::Lifespan lifespan,
+                         std::vector<BookTrade>& trades);
+
+    // Reduce an order so that its total volume (filled plus remaining)
+    // becomes volume. Returns false if the order is not in the book.
+    bool Amend(unsigned long orderId, unsigned long volume);
+
+    // Remove an order. Returns false if the order is not in the book.
+    bool Cancel(unsigned long orderId);
+
+    bool Contains(unsigned long orderId) const { return mOrders.count(orderId) != 0; }
+
+    unsigned long BestAsk() const { return mAsks.empty() ? 0 : mAsks.begin()->first; }
+    unsigned long BestBid() const { return mBids.empty() ? 0 : mBids.begin()->first; }
+
+    // Five best price levels on each side with their total volumes, padded
+    // with zeros.
+    void TopLevels(std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askPrices,
+                   std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& askVolumes,
+                   std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidPrices,
+                   std::array<unsigned long, ReadyTraderGo::TOP_LEVEL_COUNT>& bidVolumes) const;
+
+private:
+    struct Order
+    {
+        ReadyTraderGo::Side side;
+        unsigned long price;
+        unsigned long filled;
+        unsigned long remaining;
+    };
+
+    struct Level
+    {
+        unsigned long volume = 0;
+        std::deque<unsigned long> queue;
+    };
+
+    template<typename Levels>
+    void Match(Levels& levels, unsigned long orderId, ReadyTraderGo::Side side, unsigned long price,
+               unsigned long& remaining, std::vector<BookTrade>& trades);
+
+    template<typename Levels>
+    void Remove(Levels& levels, unsigned long orderId, const Order& order);
+
+    std::map<unsigned long, Level> mAsks;
+    std::map<unsigned long, Level, std::greater<unsigned long>> mBids;
+    std::unordered_map<unsigned long, Order> mOrders;
+};
+
+#endif //CPPREADY_TRADER_GO_TOOLS_ORDERBOOK_H
@@ -0,0 +1,56 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_PARALLEL_H
+#define CPPREADY_TRADER_GO_TOOLS_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Run task(i) for every i in [0, count) across all hardware threads.
+//
+// Workers claim the next unstarted index from a shared counter, so a thread
+// that finishes a short task immediately takes on more work and long tasks
+// (such as a large journal) do not leave the other cores idle.
+template<typename Task>
+void ParallelFor(std::size_t count, Task&& task)
+{
+    const std::size_t threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+        {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < threadCount; ++t)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_PARALLEL_H
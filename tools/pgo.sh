@@ -0,0 +1,103 @@
+#!/bin/sh
+# Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+#
+# This file is part of Ready Trader Go.
+#
+#     Ready Trader Go is free software: you can redistribute it and/or
+#     modify it under the terms of the GNU Affero General Public License
+#     as published by the Free Software Foundation, either version 3 of
+#     the License, or (at your option) any later version.
+#
+#     Ready Trader Go is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU Affero General Public License for more details.
+#
+#     You should have received a copy of the GNU Affero General Public
+#     License along with Ready Trader Go.  If not, see
+#     <https://www.gnu.org/licenses/>.
+
+# Profile-guided, link-time optimised build of the AutoTrader.
+#
+#   tools/pgo.sh <journal directory> [output directory]
+#
+# Builds the AutoTrader and every module it links, with handlerbench as
+# the driver, against the send-capturing BaseAutoTrader in tools/rtgdouble.
+# It is built instrumented first, and the recorded sessions are replayed
+# through the real handlers to gather branch and call profiles. It is then
+# rebuilt with those profiles and LTO. The plain and the optimised builds
+# are both benchmarked into the results store, as <commit> and
+# <commit>-pgo, and their handler latencies are compared with
+# benchcompare.
+#
+# The benchmarks run in <output directory>/run so that any journals written
+# there are kept apart from the corpus; create journals/ or traces/ there
+# to include their cost.
+#
+# RTG_INCLUDE must point at the directory holding ready_trader_go/ when it
+# is not on the default include path. CXX, CXXFLAGS and LIBS (the
+# libraries RTG logging needs) are honoured.
+
+set -e
+
+if [ $# -lt 1 ] || [ $# -gt 2 ]; then
+    echo "usage: $0 <journal directory> [output directory]" >&2
+    exit 1
+fi
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+JOURNALS=$1
+OUT=${2:-"$ROOT/_pgo_build"}
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-std=c++20 -O3 -march=native"}
+LIBS=${LIBS:-"-lboost_log -lboost_thread -lpthread"}
+INCLUDES="-I$ROOT/tools/rtgdouble${RTG_INCLUDE:+ -I$RTG_INCLUDE} -I$ROOT -I$ROOT/tools"
+RUNS=${RUNS:-15}
+COMMIT=$(git -C "$ROOT" rev-parse --short HEAD)
+SOURCES="$ROOT/tools/handlerbench.cc $ROOT/tools/benchstore.cc $ROOT/autotrader.cc $ROOT/analytics.cc \
+         $ROOT/auditlog.cc $ROOT/bookevents.cc $ROOT/journal.cc $ROOT/orderworkflow.cc $ROOT/sessionfile.cc \
+         $ROOT/signalmodel.cc $ROOT/tracing.cc $ROOT/warmstate.cc"
+
+JOURNALS=$(cd "$JOURNALS" && pwd)
+
+mkdir -p "$OUT/baseline" "$OUT/pgo" "$OUT/run"
+OUT=$(cd "$OUT" && pwd)
+rm -f "$OUT"/pgo/*.gcda
+
+build() {
+    # $1: object directory; $2: output binary; remaining arguments: extra
+    # flags. Objects keep fixed names so that the profile written next to
+    # each instrumented object is found again when it is rebuilt.
+    objects=$1
+    binary=$2
+    shift 2
+    for source in $SOURCES; do
+        # shellcheck disable=SC2086
+        $CXX $CXXFLAGS "$@" $INCLUDES -c "$source" -o "$objects/$(basename "$source" .cc).o"
+    done
+    # shellcheck disable=SC2086
+    $CXX $CXXFLAGS "$@" "$objects"/*.o -o "$binary" $LIBS
+}
+
+echo "building baseline"
+build "$OUT/baseline" "$OUT/handlerbench"
+
+echo "building instrumented"
+build "$OUT/pgo" "$OUT/handlerbench-instrumented" -fprofile-generate -fprofile-update=single
+
+cd "$OUT/run"
+
+echo "gathering profiles from $JOURNALS"
+"$OUT/handlerbench-instrumented" "$JOURNALS" "$COMMIT-instrumented" 3 "$OUT/discard" > /dev/null
+
+echo "building with profiles and LTO"
+build "$OUT/pgo" "$OUT/handlerbench-pgo" -flto=auto -fprofile-use -fprofile-partial-training
+
+echo "benchmarking handler latency before"
+"$OUT/handlerbench" "$JOURNALS" "$COMMIT" "$RUNS" "$ROOT/benchmarks"
+echo "benchmarking handler latency after"
+"$OUT/handlerbench-pgo" "$JOURNALS" "$COMMIT-pgo" "$RUNS" "$ROOT/benchmarks"
+
+echo
+"$CXX" $CXXFLAGS $INCLUDES "$ROOT/tools/benchcompare.cc" "$ROOT/tools/benchstore.cc" -o "$OUT/benchcompare"
+"$OUT/benchcompare" "$COMMIT" "$COMMIT-pgo" 0.01 "$ROOT/benchmarks" || true
@@ -0,0 +1,376 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "replay.h"
+
+using namespace ReadyTraderGo;
+
+namespace
+{
+struct ReplayFileHeader
+{
+    unsigned int magic = REPLAY_FILE_MAGIC;
+    unsigned int version = REPLAY_FILE_VERSION;
+    unsigned long build = 0;
+    unsigned long journalHash = 0;
+    unsigned long records = 0;
+    unsigned long sends = 0;
+    unsigned long checkpoints = 0;
+    QuoteParameters parameters;
+};
+
+template<typename T>
+bool WriteValue(std::ostream& stream, const T& value)
+{
+    return static_cast<bool>(stream.write(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+template<typename T>
+bool ReadValue(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template<typename T>
+bool WriteArray(std::ostream& stream, const std::vector<T>& values)
+{
+    return static_cast<bool>(stream.write(reinterpret_cast<const char*>(values.data()),
+                                          static_cast<std::streamsize>(sizeof(T) * values.size())));
+}
+
+template<typename T>
+bool ReadArray(std::istream& stream, std::vector<T>& values, std::size_t count)
+{
+    values.resize(count);
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(values.data()),
+                                         static_cast<std::streamsize>(sizeof(T) * count)));
+}
+
+// A hash of the running executable. Checkpoints hold the trader's memory
+// layout, so they are only restored by the build that wrote them. Zero if
+// the executable cannot be read, which no build matches.
+unsigned long BuildId()
+{
+    static const unsigned long id = [] {
+        std::ifstream stream("/proc/self/exe", std::ios::binary);
+        unsigned long hash = 14695981039346656037UL;
+        std::vector<char> buffer(1 << 16);
+        bool read = false;
+        while (stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || stream.gcount() > 0)
+        {
+            for (std::streamsize i = 0; i < stream.gcount(); ++i)
+            {
+                hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211UL;
+            }
+            read = true;
+        }
+        return read ? hash : 0UL;
+    }();
+    return id;
+}
+
+// The string's length is read first and checked against what is left of
+// the stream, so that a corrupt length fails rather than allocating.
+bool ReadString(std::istream& stream, std::string& value)
+{
+    unsigned long size = 0;
+    if (!ReadValue(stream, size))
+    {
+        return false;
+    }
+    const std::streampos here = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const std::streamoff left = stream.tellg() - here;
+    stream.seekg(here);
+    if (!stream || size > static_cast<unsigned long>(left))
+    {
+        return false;
+    }
+    value.resize(size);
+    return static_cast<bool>(stream.read(value.data(), static_cast<std::streamsize>(size)));
+}
+
+bool SameParameters(const QuoteParameters& a, const QuoteParameters& b)
+{
+    return a.minEdge == b.minEdge && a.positionLimit == b.positionLimit && a.lotSize == b.lotSize;
+}
+
+// Open a replay file and read its header. The state and send counts are
+// checked against the file's length before anything is allocated for them.
+bool OpenReplayFile(const std::string& filename, std::ifstream& stream, ReplayFileHeader& header,
+                    std::string& error)
+{
+    stream.open(filename, std::ios::binary);
+    if (!stream)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+    if (!ReadValue(stream, header) || header.magic != REPLAY_FILE_MAGIC)
+    {
+        error = filename + " is not a replay file";
+        return false;
+    }
+    if (header.version != REPLAY_FILE_VERSION)
+    {
+        error = filename + " has replay file version " + std::to_string(header.version) + ", expected "
+                + std::to_string(REPLAY_FILE_VERSION);
+        return false;
+    }
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(filename, ec);
+    const std::uintmax_t body = size - std::min<std::uintmax_t>(size, sizeof(header));
+    if (ec || header.records > body / sizeof(ReplayState) || header.sends > body / sizeof(ReplaySend)
+        || header.records * sizeof(ReplayState) + header.sends * sizeof(ReplaySend) > body)
+    {
+        error = "truncated replay file " + filename;
+        return false;
+    }
+    return true;
+}
+}
+
+static void MixSend(unsigned long& hash, const SentMessage& message)
+{
+    for (unsigned long value : {static_cast<unsigned long>(message.type), message.clientOrderId,
+                                static_cast<unsigned long>(message.side), message.price, message.volume})
+    {
+        hash = (hash ^ value) * 1099511628211UL;
+    }
+}
+
+Replay::Replay(const std::vector<JournalRecord>& records, const QuoteParameters& parameters)
+    : mRecords(records), mParameters(parameters), mTrader(parameters)
+{
+    TakeCheckpoint();
+}
+
+void Replay::Step()
+{
+    const JournalRecord& record = mRecords[mIndex];
+    const AutoTrader& trader = mTrader.Trader();
+    const signed long etfBefore = trader.ETFPosition();
+    const signed long futureBefore = trader.FuturePosition();
+    mTrader.Apply(record);
+
+    // Only a fill moves a position, at the price in its record.
+    const auto price = static_cast<signed long>(record.price);
+    mLedger.cash -= (trader.ETFPosition() - etfBefore) * price + (trader.FuturePosition() - futureBefore) * price;
+    if (record.type == JournalRecordType::ORDER_BOOK)
+    {
+        const bool etf = record.instrument == Instrument::ETF;
+        (etf ? mLedger.etfAskPrice : mLedger.futureAskPrice) = record.askPrices[0];
+        (etf ? mLedger.etfBidPrice : mLedger.futureBidPrice) = record.bidPrices[0];
+    }
+
+    mSent.clear();
+    mSent.swap(mTrader.Sent());
+    for (const SentMessage& message : mSent)
+    {
+        MixSend(mState.sendHash, message);
+    }
+    auto mid = [](unsigned long ask, unsigned long bid) {
+        return (ask != 0 && bid != 0) ? static_cast<signed long>(ask + bid) / 2 : 0L;
+    };
+    mState.sends += mSent.size();
+    mState.etfPosition = trader.ETFPosition();
+    mState.futurePosition = trader.FuturePosition();
+    mState.profitLoss = mLedger.cash + mState.etfPosition * mid(mLedger.etfAskPrice, mLedger.etfBidPrice)
+                        + mState.futurePosition * mid(mLedger.futureAskPrice, mLedger.futureBidPrice);
+
+    if (mIndex == mStates.size())
+    {
+        mStates.push_back(mState);
+        for (const SentMessage& message : mSent)
+        {
+            mSends.push_back({mIndex, message});
+        }
+    }
+
+    ++mIndex;
+    if (mIndex % CHECKPOINT_INTERVAL == 0 && mIndex > mCheckpoints.back().index)
+    {
+        TakeCheckpoint();
+    }
+}
+
+void Replay::TakeCheckpoint()
+{
+    std::ostringstream trader;
+    mTrader.Trader().SaveState(trader);
+    mCheckpoints.push_back({mIndex, mState, mLedger, trader.str()});
+}
+
+void Replay::Restore(const Checkpoint& checkpoint)
+{
+    // Checkpoints read from a file were restored once when they were
+    // loaded, so this cannot fail.
+    std::istringstream trader(checkpoint.trader);
+    mTrader.Restore(trader);
+    mState = checkpoint.state;
+    mLedger = checkpoint.ledger;
+    mIndex = checkpoint.index;
+}
+
+void Replay::Seek(std::size_t index)
+{
+    index = std::min(index, mRecords.size());
+    auto after = std::upper_bound(mCheckpoints.begin(), mCheckpoints.end(), index,
+                                  [](std::size_t i, const Checkpoint& checkpoint) { return i < checkpoint.index; });
+    const Checkpoint& nearest = *std::prev(after);
+    if (index < mIndex || nearest.index > mIndex)
+    {
+        Restore(nearest);
+    }
+    mSent.clear();
+    while (mIndex < index)
+    {
+        Step();
+    }
+}
+
+bool Replay::Save(const std::string& filename, std::string& error) const
+{
+    if (mStates.size() != mRecords.size())
+    {
+        error = "cannot save an incomplete replay to " + filename;
+        return false;
+    }
+
+    std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        error = "cannot create " + filename;
+        return false;
+    }
+
+    ReplayFileHeader header;
+    header.build = BuildId();
+    header.journalHash = JournalHash(mRecords);
+    header.records = mStates.size();
+    header.sends = mSends.size();
+    header.checkpoints = mCheckpoints.size();
+    header.parameters = mParameters;
+    bool ok = WriteValue(stream, header) && WriteArray(stream, mStates) && WriteArray(stream, mSends);
+    for (const Checkpoint& checkpoint : mCheckpoints)
+    {
+        ok = ok && WriteValue(stream, static_cast<unsigned long>(checkpoint.index))
+             && WriteValue(stream, checkpoint.state) && WriteValue(stream, checkpoint.ledger)
+             && WriteValue(stream, static_cast<unsigned long>(checkpoint.trader.size()))
+             && stream.write(checkpoint.trader.data(), static_cast<std::streamsize>(checkpoint.trader.size()));
+    }
+    if (!ok || !stream.flush())
+    {
+        error = "cannot write to " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::LoadCheckpoints(const std::string& filename, std::string& error)
+{
+    std::ifstream stream;
+    ReplayFileHeader header;
+    if (!OpenReplayFile(filename, stream, header, error))
+    {
+        return false;
+    }
+    if (header.build == 0 || header.build != BuildId())
+    {
+        error = filename + " was written by a different build, whose checkpoints this one cannot restore";
+        return false;
+    }
+    if (header.records != mRecords.size() || header.journalHash != JournalHash(mRecords)
+        || !SameParameters(header.parameters, mParameters))
+    {
+        error = filename + " was written for a different journal or parameters";
+        return false;
+    }
+
+    stream.seekg(static_cast<std::streamoff>(header.records * sizeof(ReplayState) + header.sends * sizeof(ReplaySend)),
+                 std::ios::cur);
+    std::vector<Checkpoint> checkpoints;
+    DrivenTrader trial(mParameters);
+    for (unsigned long i = 0; i < header.checkpoints; ++i)
+    {
+        unsigned long index = 0;
+        Checkpoint checkpoint{0, ReplayState(), Ledger(), std::string()};
+        if (!ReadValue(stream, index) || !ReadValue(stream, checkpoint.state) || !ReadValue(stream, checkpoint.ledger)
+            || !ReadString(stream, checkpoint.trader) || index > mRecords.size()
+            || (checkpoints.empty() ? index != 0 : index <= checkpoints.back().index))
+        {
+            error = "bad checkpoint " + std::to_string(i) + " in " + filename;
+            return false;
+        }
+        std::istringstream trader(checkpoint.trader);
+        if (!trial.Restore(trader) || trader.peek() != std::istringstream::traits_type::eof())
+        {
+            error = "cannot restore the trader from checkpoint " + std::to_string(i) + " in " + filename;
+            return false;
+        }
+        checkpoint.index = index;
+        checkpoints.push_back(std::move(checkpoint));
+    }
+    if (checkpoints.empty())
+    {
+        error = filename + " has no checkpoints";
+        return false;
+    }
+    mCheckpoints.swap(checkpoints);
+    return true;
+}
+
+unsigned long JournalHash(const std::vector<JournalRecord>& records)
+{
+    unsigned long hash = 14695981039346656037UL;
+    const auto* bytes = reinterpret_cast<const unsigned char*>(records.data());
+    for (std::size_t i = 0; i < records.size() * sizeof(JournalRecord); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211UL;
+    }
+    return hash;
+}
+
+bool ReadReplayFile(const std::string& filename, ReplayFile& file, std::string& error)
+{
+    std::ifstream stream;
+    ReplayFileHeader header;
+    if (!OpenReplayFile(filename, stream, header, error))
+    {
+        return false;
+    }
+    file.journalHash = header.journalHash;
+    file.parameters = header.parameters;
+    if (!ReadArray(stream, file.states, header.records) || !ReadArray(stream, file.sends, header.sends))
+    {
+        error = "truncated replay file " + filename;
+        return false;
+    }
+    return true;
+}
+
+std::size_t FirstDivergence(const std::vector<ReplayState>& a, const std::vector<ReplayState>& b)
+{
+    const std::size_t size = std::min(a.size(), b.size());
+    return std::mismatch(a.begin(), a.begin() + static_cast<std::ptrdiff_t>(size), b.begin()).first - a.begin();
+}
@@ -0,0 +1,179 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_REPLAY_H
+#define CPPREADY_TRADER_GO_TOOLS_REPLAY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <ready_trader_go/baseautotrader.h>
+
+#include "driventrader.h"
+#include "journal.h"
+#include "quotekernel.h"
+
+constexpr std::size_t CHECKPOINT_INTERVAL = 4096; // journal records
+constexpr unsigned int REPLAY_FILE_MAGIC = 0x52475452; // "RTGR"
+constexpr unsigned int REPLAY_FILE_VERSION = 2;
+constexpr char REPLAY_FILE_EXTENSION[] = ".rtgr";
+
+// What two replays of the same journal are compared on after each record:
+// positions, marked PnL and the sends so far, as a count and a running
+// hash of the messages.
+struct ReplayState
+{
+    signed long etfPosition = 0;
+    signed long futurePosition = 0;
+    signed long profitLoss = 0;
+    unsigned long sends = 0;
+    unsigned long sendHash = 14695981039346656037UL;
+
+    bool operator==(const ReplayState& other) const
+    {
+        return etfPosition == other.etfPosition && futurePosition == other.futurePosition
+               && profitLoss == other.profitLoss && sends == other.sends && sendHash == other.sendHash;
+    }
+    bool operator!=(const ReplayState& other) const { return !(*this == other); }
+};
+
+// A message sent by a replay, and the index of the record it responded to.
+struct ReplaySend
+{
+    std::size_t trigger;
+    ReadyTraderGo::SentMessage message;
+};
+
+// A complete replay of one journal as saved to a replay file, less its
+// trader snapshots. The states and sends depend only on the build that
+// wrote the file, so files from two builds, or two corpora, can be
+// compared without running either.
+//
+// Replay files are native-endian binary:
+//   uint32 magic, uint32 version, uint64 build id,
+//   uint64 journal hash, uint64 record count, uint64 send count,
+//   uint64 checkpoint count, QuoteParameters,
+//   ReplayState states[record count], one after each record,
+//   ReplaySend sends[send count],
+//   then per checkpoint: uint64 record index, ReplayState, the replay's
+//   cash and prices, uint64 trader state size, the trader state as
+//   written by AutoTrader::SaveState
+struct ReplayFile
+{
+    unsigned long journalHash = 0;
+    QuoteParameters parameters;
+    std::vector<ReplayState> states;
+    std::vector<ReplaySend> sends;
+};
+
+// FNV-1a over a journal's records, identifying the journal a replay file
+// was written for.
+unsigned long JournalHash(const std::vector<JournalRecord>& records);
+
+bool ReadReplayFile(const std::string& filename, ReplayFile& file, std::string& error);
+
+// A journal's inbound messages replayed through the AutoTrader, as a
+// DrivenTrader, one record at a time. The replay marks the trader's
+// positions itself, from the prices of the fills that moved them and the
+// latest books. Every CHECKPOINT_INTERVAL records the trader's state is
+// saved aside with the replay's, so a seek restores the nearest checkpoint
+// at or before its target and replays only the records after it.
+// Checkpoints are saved with the rest of a complete replay, so a later
+// process can load them and seek without replaying from the start.
+class Replay
+{
+public:
+    Replay(const std::vector<JournalRecord>& records, const QuoteParameters& parameters);
+
+    // Write the replay, which must have been stepped through every record
+    // from the start, to a replay file.
+    bool Save(const std::string& filename, std::string& error) const;
+
+    // Replace the checkpoints with those of a replay file written for the
+    // same journal and parameters by this same build.
+    // Each is restored once here, so that one this build cannot read is
+    // reported now rather than at a seek. Returns false and describes the
+    // problem in error otherwise, leaving the replay as it was.
+    bool LoadCheckpoints(const std::string& filename, std::string& error);
+
+    // Apply the next record. Its sends are left in Sent() until the next
+    // step or seek.
+    void Step();
+
+    // Position the replay so that the next record applied is index, which
+    // may be records.size().
+    void Seek(std::size_t index);
+
+    bool Done() const { return mIndex == mRecords.size(); }
+    std::size_t Size() const { return mRecords.size(); }
+    std::size_t Index() const { return mIndex; }
+    const ReplayState& State() const { return mState; }
+    const std::vector<ReadyTraderGo::SentMessage>& Sent() const { return mSent; }
+
+    // The state after each record and every send, so far as the records
+    // have been stepped through in order from the start.
+    const std::vector<ReplayState>& States() const { return mStates; }
+    const std::vector<ReplaySend>& Sends() const { return mSends; }
+
+    // The checkpoints taken so far, in record order.
+    std::size_t Checkpoints() const { return mCheckpoints.size(); }
+    std::size_t CheckpointIndex(std::size_t checkpoint) const { return mCheckpoints[checkpoint].index; }
+    const ReplayState& CheckpointState(std::size_t checkpoint) const { return mCheckpoints[checkpoint].state; }
+
+private:
+    // Cash from the trader's fills and the latest top of each book, which
+    // its positions are marked to.
+    struct Ledger
+    {
+        signed long cash = 0;
+        unsigned long etfAskPrice = 0;
+        unsigned long etfBidPrice = 0;
+        unsigned long futureAskPrice = 0;
+        unsigned long futureBidPrice = 0;
+    };
+
+    struct Checkpoint
+    {
+        std::size_t index;
+        ReplayState state;
+        Ledger ledger;
+        std::string trader; // as written by AutoTrader::SaveState
+    };
+
+    void TakeCheckpoint();
+    void Restore(const Checkpoint& checkpoint);
+
+    const std::vector<JournalRecord>& mRecords;
+    QuoteParameters mParameters;
+    DrivenTrader mTrader;
+    Ledger mLedger;
+    ReplayState mState;
+    std::size_t mIndex = 0;
+    std::vector<ReadyTraderGo::SentMessage> mSent;
+    std::vector<ReplayState> mStates;
+    std::vector<ReplaySend> mSends;
+    std::vector<Checkpoint> mCheckpoints;
+};
+
+// Find the first record after which two streams of replay states differ.
+// A difference in positions or PnL can go away again, so every state is
+// compared. Returns the index of the record, or the length of the shorter
+// stream if they agree throughout it.
+std::size_t FirstDivergence(const std::vector<ReplayState>& a, const std::vector<ReplayState>& b);
+
+#endif //CPPREADY_TRADER_GO_TOOLS_REPLAY_H
@@ -0,0 +1,641 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ready_trader_go/baseautotrader.h>
+
+#include "journal.h"
+#include "parallel.h"
+#include "replay.h"
+
+using namespace ReadyTraderGo;
+
+// Replays a corpus of journals through two sources of trading behaviour and
+// compares the order messages each one sends.
+//
+// A source is one of:
+//   recorded          the sends recorded in the journal itself
+//   replay[:e,l,s]    the journal's inbound messages replayed through this
+//                     build's AutoTrader, optionally with min edge (ticks),
+//                     position limit and lot size overrides
+//   <directory>       the sends recorded in the journal of the same name in
+//                     another corpus, which must have the same inbound
+//                     messages
+//   checkpoints:<dir> the sends and replay states in the replay file of the
+//                     same name in dir, written by --save, perhaps by
+//                     another build
+//
+// Replays run the competition AutoTrader against the send-capturing
+// BaseAutoTrader in tools/rtgdouble, so this is built as handlerbench is,
+// and use the signal model in the working directory if there is one. The
+// trader's clock is each record's journal timestamp, taken as the live
+// handler was entered, so a replay can pace a send differently from the
+// recording only at the edge of a pacing window.
+//
+// Every journal gets a hash of each source's send sequence, and the first
+// divergence is reported with the inbound messages that led up to it. The
+// exit status is non-zero if any journal diverges, so this can gate changes
+// that must not alter behaviour.
+//
+// --save <dir> writes the candidate replay, with its state after every
+// record and its checkpoints, to a replay file in dir, so that a later run
+// of this or another build can compare against it without replaying again.
+//
+// When both sources are replays or replay files, --bisect also finds the
+// first record after which their positions, marked PnL or sends differ, by
+// comparing their state streams, and --seek <record> shows each replay's
+// state just before the given record, resuming a replay file from its
+// nearest saved checkpoint if this build wrote it.
+
+constexpr std::size_t CONTEXT_RECORDS = 5;
+constexpr std::size_t CONTEXT_SENDS = 3;
+constexpr signed long TICK_SIZE_IN_CENTS = 100;
+
+// One order message, and the index of the inbound record it responded to.
+struct Send
+{
+    JournalRecordType type;
+    unsigned long clientOrderId;
+    Side side;
+    unsigned long price;
+    unsigned long volume;
+    std::size_t trigger;
+
+    bool operator==(const Send& other) const
+    {
+        return type == other.type && clientOrderId == other.clientOrderId && side == other.side
+               && price == other.price && volume == other.volume && trigger == other.trigger;
+    }
+};
+
+struct Options
+{
+    bool bisect = false;
+    bool seek = false;
+    std::size_t seekIndex = 0;
+    std::filesystem::path saveDirectory;
+};
+
+struct Source
+{
+    enum class Kind
+    {
+        RECORDED,
+        REPLAY,
+        CORPUS,
+        CHECKPOINTS
+    };
+
+    Kind kind = Kind::RECORDED;
+    QuoteParameters parameters;
+    std::filesystem::path directory;
+    std::string name;
+};
+
+// What a source produced for one journal. Replays and replay files also
+// have the state after each record.
+struct Collected
+{
+    std::vector<Send> sends;
+    std::vector<ReplayState> states;
+    bool hasStates = false;
+    QuoteParameters parameters;
+    std::unique_ptr<Replay> replay;
+    std::filesystem::path replayFile;
+};
+
+// Cancels are journaled with only their order id, so their other fields
+// are cleared before comparison.
+static Send MakeSend(JournalRecordType type, unsigned long clientOrderId, Side side, unsigned long price,
+                     unsigned long volume, std::size_t trigger)
+{
+    const bool cancel = type == JournalRecordType::CANCEL_ORDER;
+    return {type, clientOrderId, cancel ? Side::BUY : side, cancel ? 0 : price, cancel ? 0 : volume, trigger};
+}
+
+static bool IsInbound(JournalRecordType type)
+{
+    return type < JournalRecordType::INSERT_ORDER;
+}
+
+static bool IsSend(JournalRecordType type)
+{
+    return type == JournalRecordType::INSERT_ORDER || type == JournalRecordType::CANCEL_ORDER
+           || type == JournalRecordType::HEDGE_ORDER;
+}
+
+static bool ParseSource(const std::string& text, Source& source)
+{
+    source.name = text;
+    if (text == "recorded")
+    {
+        source.kind = Source::Kind::RECORDED;
+        return true;
+    }
+    if (text.rfind("replay", 0) == 0)
+    {
+        source.kind = Source::Kind::REPLAY;
+        if (text.size() > 6)
+        {
+            signed long edge = 0;
+            char comma1 = 0;
+            char comma2 = 0;
+            std::istringstream stream(text.substr(7));
+            if (text[6] != ':' || !(stream >> edge >> comma1 >> source.parameters.positionLimit >> comma2
+                                    >> source.parameters.lotSize) || comma1 != ',' || comma2 != ',')
+            {
+                return false;
+            }
+            source.parameters.minEdge = edge * TICK_SIZE_IN_CENTS;
+        }
+        return true;
+    }
+    if (text.rfind("checkpoints:", 0) == 0)
+    {
+        source.kind = Source::Kind::CHECKPOINTS;
+        source.directory = text.substr(12);
+        return std::filesystem::is_directory(source.directory);
+    }
+    source.kind = Source::Kind::CORPUS;
+    source.directory = text;
+    return std::filesystem::is_directory(source.directory);
+}
+
+static void RecordedSends(const std::vector<JournalRecord>& records, std::vector<Send>& sends)
+{
+    std::size_t trigger = 0;
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        const JournalRecord& record = records[i];
+        if (IsInbound(record.type))
+        {
+            trigger = i;
+        }
+        else if (IsSend(record.type))
+        {
+            sends.push_back(MakeSend(record.type, record.clientOrderId, record.side, record.price, record.volume,
+                                     trigger));
+        }
+    }
+}
+
+// The AutoTrader never amends and journals have no record of an amend, so
+// amends are left out of the comparison.
+static void AddSends(const std::vector<ReplaySend>& replaySends, std::vector<Send>& sends)
+{
+    for (const ReplaySend& send : replaySends)
+    {
+        const SentMessage& message = send.message;
+        JournalRecordType type;
+        switch (message.type)
+        {
+        case SentMessage::Type::INSERT:
+            type = JournalRecordType::INSERT_ORDER;
+            break;
+        case SentMessage::Type::CANCEL:
+            type = JournalRecordType::CANCEL_ORDER;
+            break;
+        case SentMessage::Type::HEDGE:
+            type = JournalRecordType::HEDGE_ORDER;
+            break;
+        default:
+            continue;
+        }
+        sends.push_back(MakeSend(type, message.clientOrderId, message.side, message.price, message.volume,
+                                 send.trigger));
+    }
+}
+
+static void ReplaySends(const std::vector<JournalRecord>& records, const QuoteParameters& parameters,
+                        Collected& collected)
+{
+    collected.replay = std::make_unique<Replay>(records, parameters);
+    while (!collected.replay->Done())
+    {
+        collected.replay->Step();
+    }
+    AddSends(collected.replay->Sends(), collected.sends);
+    collected.states = collected.replay->States();
+    collected.hasStates = true;
+    collected.parameters = parameters;
+}
+
+static std::filesystem::path ReplayFileName(const std::filesystem::path& directory, const std::string& filename)
+{
+    return directory / (std::filesystem::path(filename).stem().string() + REPLAY_FILE_EXTENSION);
+}
+
+static bool ReplayFileSends(const std::vector<JournalRecord>& records, const std::filesystem::path& path,
+                            Collected& collected, std::string& error)
+{
+    ReplayFile file;
+    if (!ReadReplayFile(path.string(), file, error))
+    {
+        return false;
+    }
+    if (file.journalHash != JournalHash(records) || file.states.size() != records.size())
+    {
+        error = path.string() + " was written for a different journal";
+        return false;
+    }
+    AddSends(file.sends, collected.sends);
+    collected.states = std::move(file.states);
+    collected.hasStates = true;
+    collected.parameters = file.parameters;
+    collected.replayFile = path;
+    return true;
+}
+
+static bool SameInbound(const std::vector<JournalRecord>& a, const std::vector<JournalRecord>& b, std::size_t& index)
+{
+    std::vector<const JournalRecord*> left;
+    std::vector<const JournalRecord*> right;
+    for (const JournalRecord& record : a)
+    {
+        if (IsInbound(record.type))
+        {
+            left.push_back(&record);
+        }
+    }
+    for (const JournalRecord& record : b)
+    {
+        if (IsInbound(record.type))
+        {
+            right.push_back(&record);
+        }
+    }
+    for (index = 0; index < std::min(left.size(), right.size()); ++index)
+    {
+        const JournalRecord& l = *left[index];
+        const JournalRecord& r = *right[index];
+        if (l.type != r.type || l.instrument != r.instrument || l.sequenceNumber != r.sequenceNumber
+            || l.clientOrderId != r.clientOrderId || l.price != r.price || l.volume != r.volume
+            || l.remainingVolume != r.remainingVolume || l.askPrices != r.askPrices
+            || l.askVolumes != r.askVolumes || l.bidPrices != r.bidPrices || l.bidVolumes != r.bidVolumes)
+        {
+            return false;
+        }
+    }
+    return left.size() == right.size();
+}
+
+static bool CollectSends(const Source& source, const std::string& filename,
+                         const std::vector<JournalRecord>& records, Collected& collected, std::string& error)
+{
+    std::vector<Send>& sends = collected.sends;
+    switch (source.kind)
+    {
+    case Source::Kind::RECORDED:
+        RecordedSends(records, sends);
+        return true;
+    case Source::Kind::REPLAY:
+        ReplaySends(records, source.parameters, collected);
+        return true;
+    case Source::Kind::CHECKPOINTS:
+        return ReplayFileSends(records, ReplayFileName(source.directory, filename), collected, error);
+    case Source::Kind::CORPUS:
+    {
+        std::vector<JournalRecord> other;
+        const std::filesystem::path path = source.directory / std::filesystem::path(filename).filename();
+        if (!ReadJournal(path.string(), other, error))
+        {
+            return false;
+        }
+        std::size_t index = 0;
+        if (!SameInbound(records, other, index))
+        {
+            error = path.string() + " has different inbound messages from inbound record "
+                    + std::to_string(index);
+            return false;
+        }
+        // Map the other journal's trigger indices onto this journal's.
+        std::vector<std::size_t> inboundIndex;
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            if (IsInbound(records[i].type))
+            {
+                inboundIndex.push_back(i);
+            }
+        }
+        std::size_t seen = 0;
+        std::size_t trigger = 0;
+        for (const JournalRecord& record : other)
+        {
+            if (IsInbound(record.type))
+            {
+                trigger = inboundIndex[seen++];
+            }
+            else if (IsSend(record.type))
+            {
+                sends.push_back(MakeSend(record.type, record.clientOrderId, record.side, record.price,
+                                         record.volume, trigger));
+            }
+        }
+        return true;
+    }
+    }
+    return false;
+}
+
+static unsigned long HashSends(const std::vector<Send>& sends)
+{
+    // FNV-1a over each field.
+    unsigned long hash = 14695981039346656037UL;
+    auto mix = [&hash](unsigned long value) {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash = (hash ^ ((value >> (8 * i)) & 0xff)) * 1099511628211UL;
+        }
+    };
+    for (const Send& send : sends)
+    {
+        mix(static_cast<unsigned long>(send.type));
+        mix(send.clientOrderId);
+        mix(static_cast<unsigned long>(send.side));
+        mix(send.price);
+        mix(send.volume);
+        mix(send.trigger);
+    }
+    return hash;
+}
+
+static const char* TypeName(JournalRecordType type)
+{
+    static const char* const NAMES[] = {"order_book", "trade_ticks", "order_filled", "order_status",
+                                        "hedge_filled", "error", "disconnect", "insert", "cancel", "hedge",
+                                        "opportunity", "round_trip"};
+    return NAMES[static_cast<unsigned char>(type)];
+}
+
+static void DescribeRecord(std::ostream& out, std::size_t index, const JournalRecord& record)
+{
+    out << "    [" << index << "] " << TypeName(record.type);
+    switch (record.type)
+    {
+    case JournalRecordType::ORDER_BOOK:
+    case JournalRecordType::TRADE_TICKS:
+        out << (record.instrument == Instrument::ETF ? " etf" : " future") << " seq " << record.sequenceNumber
+            << " bid " << record.bidVolumes[0] << '@' << record.bidPrices[0]
+            << " ask " << record.askVolumes[0] << '@' << record.askPrices[0];
+        break;
+    case JournalRecordType::ORDER_STATUS:
+        out << " id " << record.clientOrderId << " filled " << record.volume << " remaining "
+            << record.remainingVolume;
+        break;
+    default:
+        out << " id " << record.clientOrderId << ' ' << record.volume << '@' << record.price;
+        break;
+    }
+    out << '\n';
+}
+
+static void DescribeSends(std::ostream& out, const std::string& name, const std::vector<Send>& sends,
+                          std::size_t from)
+{
+    out << "  " << name << ":\n";
+    for (std::size_t i = from; i < std::min(sends.size(), from + CONTEXT_SENDS); ++i)
+    {
+        const Send& send = sends[i];
+        out << "    #" << i << ' ' << TypeName(send.type) << " id " << send.clientOrderId;
+        if (send.type != JournalRecordType::CANCEL_ORDER)
+        {
+            out << (send.side == Side::BUY ? " buy " : " sell ") << send.volume << '@' << send.price;
+        }
+        out << " after [" << send.trigger << "]\n";
+    }
+    if (from >= sends.size())
+    {
+        out << "    (no more sends)\n";
+    }
+}
+
+static void DescribeState(std::ostream& out, const std::string& name, const ReplayState& state)
+{
+    out << "    " << name << ": etf " << state.etfPosition << " future " << state.futurePosition << " pnl "
+        << state.profitLoss << " sends " << state.sends << '\n';
+}
+
+static void DescribeDivergence(std::ostream& out, const std::vector<JournalRecord>& records, const Source& baseline,
+                               const Collected& a, const Source& candidate, const Collected& b)
+{
+    const std::size_t index = FirstDivergence(a.states, b.states);
+    if (index == a.states.size() || index == b.states.size())
+    {
+        out << "  replay states agree throughout\n";
+        return;
+    }
+    out << "  replay states first differ after:\n";
+    DescribeRecord(out, index, records[index]);
+    DescribeState(out, baseline.name, a.states[index]);
+    DescribeState(out, candidate.name, b.states[index]);
+}
+
+static void Seek(std::ostream& out, const std::vector<JournalRecord>& records, std::size_t index,
+                 const Source& source, const Collected& collected)
+{
+    if (collected.replay)
+    {
+        // The replay has run to the end, so every checkpoint is available.
+        collected.replay->Seek(index);
+        DescribeState(out, source.name, collected.replay->State());
+        return;
+    }
+    if (!collected.hasStates)
+    {
+        return;
+    }
+
+    const ReplayState saved = (index == 0) ? ReplayState() : collected.states[index - 1];
+    Replay replay(records, collected.parameters);
+    std::string error;
+    if (!replay.LoadCheckpoints(collected.replayFile.string(), error))
+    {
+        DescribeState(out, source.name, saved);
+        out << "      from the saved states: " << error << '\n';
+        return;
+    }
+    replay.Seek(index);
+    DescribeState(out, source.name, replay.State());
+    if (replay.State() != saved)
+    {
+        out << "      this build resumes differently from the saved states, which have:\n";
+        DescribeState(out, source.name, saved);
+    }
+}
+
+static void DescribeReplays(std::ostream& out, const std::vector<JournalRecord>& records, const Source& baseline,
+                            Collected& a, const Source& candidate, Collected& b, const Options& options)
+{
+    if (options.seek)
+    {
+        const std::size_t index = std::min(options.seekIndex, records.size());
+        out << "  state before record [" << index << "]:\n";
+        Seek(out, records, index, baseline, a);
+        Seek(out, records, index, candidate, b);
+    }
+    if (options.bisect && a.hasStates && b.hasStates)
+    {
+        DescribeDivergence(out, records, baseline, a, candidate, b);
+    }
+}
+
+// Compare one journal and describe the outcome. Returns true if the two
+// sources agree.
+static bool Compare(const std::string& filename, const Source& baseline, const Source& candidate,
+                    const Options& options, std::string& report)
+{
+    std::ostringstream out;
+    out << std::filesystem::path(filename).filename().string() << ": ";
+
+    std::vector<JournalRecord> records;
+    Collected a;
+    Collected b;
+    std::string error;
+    if (!ReadJournal(filename, records, error) || !CollectSends(baseline, filename, records, a, error)
+        || !CollectSends(candidate, filename, records, b, error)
+        || (!options.saveDirectory.empty()
+            && !b.replay->Save(ReplayFileName(options.saveDirectory, filename).string(), error)))
+    {
+        report = out.str() + "ERROR " + error + "\n";
+        return false;
+    }
+    const std::vector<Send>& expected = a.sends;
+    const std::vector<Send>& actual = b.sends;
+
+    const unsigned long expectedHash = HashSends(expected);
+    const unsigned long actualHash = HashSends(actual);
+    out << expected.size() << '/' << actual.size() << " sends, hash " << std::hex << std::setfill('0')
+        << std::setw(16) << expectedHash << '/' << std::setw(16) << actualHash << std::dec;
+    const auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin(), actual.end());
+    if (mismatch.first == expected.end() && mismatch.second == actual.end())
+    {
+        out << " OK\n";
+        DescribeReplays(out, records, baseline, a, candidate, b, options);
+        report = out.str();
+        return true;
+    }
+
+    const std::size_t at = mismatch.first - expected.begin();
+    const std::size_t trigger = std::min(at < expected.size() ? expected[at].trigger : records.size(),
+                                         at < actual.size() ? actual[at].trigger : records.size());
+    out << " DIVERGED at send #" << at << "\n  inbound messages up to the divergence:\n";
+    std::size_t shown = 0;
+    std::size_t start = std::min(trigger + 1, records.size());
+    while (start > 0 && shown < CONTEXT_RECORDS)
+    {
+        --start;
+        shown += IsInbound(records[start].type) ? 1 : 0;
+    }
+    for (std::size_t i = start; i < std::min(trigger + 1, records.size()); ++i)
+    {
+        if (IsInbound(records[i].type))
+        {
+            DescribeRecord(out, i, records[i]);
+        }
+    }
+    DescribeSends(out, baseline.name, expected, at);
+    DescribeSends(out, candidate.name, actual, at);
+    DescribeReplays(out, records, baseline, a, candidate, b, options);
+    report = out.str();
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--bisect")
+        {
+            options.bisect = true;
+        }
+        else if (argument == "--seek" && i + 1 < argc)
+        {
+            options.seek = true;
+            options.seekIndex = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--save" && i + 1 < argc)
+        {
+            options.saveDirectory = argv[++i];
+        }
+        else
+        {
+            arguments.push_back(argument);
+        }
+    }
+    if (arguments.empty() || arguments.size() > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " [--bisect] [--seek <record>] [--save <directory>]"
+                  << " <journal file or directory> [baseline] [candidate]" << std::endl
+                  << "sources: recorded (default baseline), replay[:min edge ticks,position limit,lot size]"
+                  << " (default candidate), checkpoints:<replay file directory>, or another journal directory"
+                  << std::endl;
+        return 1;
+    }
+
+    Source baseline;
+    Source candidate;
+    if (!ParseSource(arguments.size() > 1 ? arguments[1] : "recorded", baseline)
+        || !ParseSource(arguments.size() > 2 ? arguments[2] : "replay", candidate))
+    {
+        std::cerr << "bad source" << std::endl;
+        return 1;
+    }
+    if (!options.saveDirectory.empty()
+        && (candidate.kind != Source::Kind::REPLAY || !std::filesystem::is_directory(options.saveDirectory)))
+    {
+        std::cerr << "--save needs a replay candidate and an existing directory" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path input(arguments[0]);
+    const std::vector<std::string> journals = std::filesystem::is_directory(input)
+                                              ? ListJournals(input.string())
+                                              : std::vector<std::string>{input.string()};
+    if (journals.empty())
+    {
+        std::cerr << "no journals found in " << input << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> reports(journals.size());
+    std::vector<char> agreed(journals.size());
+    ParallelFor(journals.size(), [&](std::size_t i) {
+        agreed[i] = Compare(journals[i], baseline, candidate, options, reports[i]);
+    });
+
+    std::size_t diverged = 0;
+    for (std::size_t i = 0; i < journals.size(); ++i)
+    {
+        std::cout << reports[i];
+        diverged += agreed[i] ? 0 : 1;
+    }
+    std::cout << journals.size() - diverged << " of " << journals.size() << " journals match" << std::endl;
+    return diverged == 0 ? 0 : 1;
+}
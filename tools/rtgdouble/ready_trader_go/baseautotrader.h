@@ -0,0 +1,146 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_RTGDOUBLE_BASEAUTOTRADER_H
+#define CPPREADY_TRADER_GO_TOOLS_RTGDOUBLE_BASEAUTOTRADER_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <ready_trader_go/types.h>
+
+namespace ReadyTraderGo
+{
+
+// An order message the trader sent. Fields a message does not carry are
+// zero.
+struct SentMessage
+{
+    enum class Type
+    {
+        AMEND,
+        CANCEL,
+        HEDGE,
+        INSERT
+    };
+
+    Type type;
+    unsigned long clientOrderId;
+    Side side;
+    unsigned long price;
+    unsigned long volume;
+    Lifespan lifespan;
+};
+
+// A stand-in for the RTG library's BaseAutoTrader with no exchange
+// connections, so that the real AutoTrader handlers can be driven from
+// recorded or simulated messages by the benchmark, profiling, replay and
+// simulation tools. Sends are counted and collected for the driver, which
+// takes them from Sent().
+//
+// Put this directory on the include path ahead of the RTG library; the
+// rest of ready_trader_go/ (types, logging) still comes from the library.
+class BaseAutoTrader
+{
+public:
+    explicit BaseAutoTrader(boost::asio::io_context& context) : mContext(context)
+    {
+    }
+
+    virtual ~BaseAutoTrader() = default;
+
+    virtual void DisconnectHandler()
+    {
+    }
+
+    virtual void ErrorMessageHandler(unsigned long clientOrderId, const std::string& errorMessage) = 0;
+    virtual void HedgeFilledMessageHandler(unsigned long clientOrderId,
+                                           unsigned long price,
+                                           unsigned long volume) = 0;
+    virtual void OrderBookMessageHandler(Instrument instrument,
+                                         unsigned long sequenceNumber,
+                                         const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                         const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                         const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                         const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) = 0;
+    virtual void OrderFilledMessageHandler(unsigned long clientOrderId,
+                                           unsigned long price,
+                                           unsigned long volume) = 0;
+    virtual void OrderStatusMessageHandler(unsigned long clientOrderId,
+                                           unsigned long fillVolume,
+                                           unsigned long remainingVolume,
+                                           signed long fees) = 0;
+    virtual void TradeTicksMessageHandler(Instrument instrument,
+                                          unsigned long sequenceNumber,
+                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askPrices,
+                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& askVolumes,
+                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidPrices,
+                                          const std::array<unsigned long, TOP_LEVEL_COUNT>& bidVolumes) = 0;
+
+    void SendAmendOrder(unsigned long clientOrderId, unsigned long volume)
+    {
+        Send({SentMessage::Type::AMEND, clientOrderId, Side::SELL, 0, volume, Lifespan::FILL_AND_KILL});
+    }
+
+    void SendCancelOrder(unsigned long clientOrderId)
+    {
+        Send({SentMessage::Type::CANCEL, clientOrderId, Side::SELL, 0, 0, Lifespan::FILL_AND_KILL});
+    }
+
+    void SendHedgeOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume)
+    {
+        Send({SentMessage::Type::HEDGE, clientOrderId, side, price, volume, Lifespan::FILL_AND_KILL});
+    }
+
+    void SendInsertOrder(unsigned long clientOrderId, Side side, unsigned long price, unsigned long volume,
+                         Lifespan lifespan)
+    {
+        Send({SentMessage::Type::INSERT, clientOrderId, side, price, volume, lifespan});
+    }
+
+    // Every message sent since construction.
+    unsigned long SentMessages() const
+    {
+        return mSentMessages;
+    }
+
+    // The messages sent since the driver last cleared this, oldest first.
+    std::vector<SentMessage>& Sent()
+    {
+        return mSent;
+    }
+
+protected:
+    boost::asio::io_context& mContext;
+
+private:
+    void Send(const SentMessage& message)
+    {
+        ++mSentMessages;
+        mSent.push_back(message);
+    }
+
+    unsigned long mSentMessages = 0;
+    std::vector<SentMessage> mSent;
+};
+
+}
+
+#endif //CPPREADY_TRADER_GO_TOOLS_RTGDOUBLE_BASEAUTOTRADER_H
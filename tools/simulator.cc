@@ -0,0 +1,366 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+#include "driventrader.h"
+#include "messagepacer.h"
+#include "simulator.h"
+
+using namespace ReadyTraderGo;
+
+// Competition rules enforced by the simulated exchange.
+constexpr signed long POSITION_LIMIT = 100;
+constexpr signed long UNHEDGED_LOTS_LIMIT = 10;
+constexpr double HEDGE_DEADLINE_SECONDS = 60.0;
+constexpr double ETF_MAKER_FEE = -0.0001;
+constexpr double ETF_TAKER_FEE = 0.0002;
+
+constexpr unsigned long TICK_SIZE_IN_CENTS = 100;
+constexpr double INITIAL_MID = 10000.0;
+
+namespace
+{
+
+struct Book
+{
+    std::array<unsigned long, TOP_LEVEL_COUNT> askPrices{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> askVolumes{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> bidPrices{};
+    std::array<unsigned long, TOP_LEVEL_COUNT> bidVolumes{};
+};
+
+struct RestingOrder
+{
+    Side side;
+    unsigned long price;
+    unsigned long remaining;
+    unsigned long filled = 0;
+    signed long fees = 0;
+};
+
+// The market, our ETF orders, and the rules, for one session.
+class SimulatedExchange
+{
+public:
+    SimulatedExchange(const SessionConfig& config, DrivenTrader& trader)
+        : mConfig(config), mTrader(trader), mRandom(config.seed)
+    {
+        BuildBook(mFuture, mFutureMid);
+        BuildBook(mETF, mFutureMid + mBasis);
+    }
+
+    SessionResult Run();
+
+private:
+    std::chrono::nanoseconds Time() const;
+    void BuildBook(Book& book, double mid);
+    void MoveMarket();
+    signed long WorstCasePosition(Side side) const;
+    void Deliver(const SentMessage& message);
+    void Fill(unsigned long clientOrderId, RestingOrder& order, unsigned long price, unsigned long volume, double fee);
+    void FillRestingOrders();
+    void Collect();
+    void CheckRules();
+
+    const SessionConfig& mConfig;
+    DrivenTrader& mTrader;
+    std::mt19937_64 mRandom;
+    std::normal_distribution<double> mNormal;
+    std::uniform_real_distribution<double> mUniform;
+
+    double mNow = 0.0;
+    double mFutureMid = INITIAL_MID;
+    double mBasis = 0.0;
+    Book mFuture;
+    Book mETF;
+
+    std::map<unsigned long, RestingOrder> mOrders;
+    std::deque<std::pair<double, SentMessage>> mInFlight;
+    std::deque<double> mRecentMessages;
+    unsigned long mLastOrderId = 0;
+    unsigned long mSequenceNumber = 0;
+
+    signed long mETFPosition = 0;
+    signed long mFuturePosition = 0;
+    signed long mCash = 0;
+    double mUnhedgedSince = -1.0;
+    bool mHedgeBreached = false;
+    SessionResult mResult;
+};
+
+std::chrono::nanoseconds SimulatedExchange::Time() const
+{
+    return std::chrono::nanoseconds(std::llround(mNow * 1e9));
+}
+
+void SimulatedExchange::BuildBook(Book& book, double mid)
+{
+    const auto bid = static_cast<unsigned long>(std::floor(mid / TICK_SIZE_IN_CENTS)) * TICK_SIZE_IN_CENTS;
+    std::uniform_int_distribution<unsigned long> volume(20, 200);
+    for (std::size_t i = 0; i < TOP_LEVEL_COUNT; ++i)
+    {
+        book.bidPrices[i] = bid - i * TICK_SIZE_IN_CENTS;
+        book.askPrices[i] = bid + (i + 1) * TICK_SIZE_IN_CENTS;
+        book.bidVolumes[i] = volume(mRandom);
+        book.askVolumes[i] = volume(mRandom);
+    }
+}
+
+void SimulatedExchange::MoveMarket()
+{
+    const double dt = mConfig.stepSeconds;
+    mFutureMid *= std::exp(mConfig.volatility * std::sqrt(dt) * mNormal(mRandom));
+    mBasis += -mConfig.basisReversion * mBasis * dt
+              + mConfig.basisNoise * std::sqrt(2.0 * mConfig.basisReversion * dt) * mNormal(mRandom);
+    BuildBook(mFuture, mFutureMid);
+    BuildBook(mETF, mFutureMid + mBasis);
+}
+
+void SimulatedExchange::Fill(unsigned long clientOrderId, RestingOrder& order, unsigned long price,
+                             unsigned long volume, double fee)
+{
+    const auto signedVolume = static_cast<signed long>(volume);
+    const auto notional = static_cast<signed long>(price) * signedVolume;
+    const auto fees = static_cast<signed long>(std::lround(static_cast<double>(notional) * fee));
+    mETFPosition += (order.side == Side::BUY) ? signedVolume : -signedVolume;
+    mCash += ((order.side == Side::BUY) ? -notional : notional) - fees;
+    mResult.etfVolume += volume;
+    order.remaining -= volume;
+    order.filled += volume;
+    order.fees += fees;
+    mTrader.Trader().OrderFilledMessageHandler(clientOrderId, price, volume);
+    mTrader.Trader().OrderStatusMessageHandler(clientOrderId, order.filled, order.remaining, order.fees);
+}
+
+signed long SimulatedExchange::WorstCasePosition(Side side) const
+{
+    signed long position = (side == Side::BUY) ? mETFPosition : -mETFPosition;
+    for (const auto& [clientOrderId, order] : mOrders)
+    {
+        position += (order.side == side) ? static_cast<signed long>(order.remaining) : 0;
+    }
+    return position;
+}
+
+void SimulatedExchange::Deliver(const SentMessage& message)
+{
+    while (!mRecentMessages.empty() && mRecentMessages.front() <= mNow - 1.0)
+    {
+        mRecentMessages.pop_front();
+    }
+    mRecentMessages.push_back(mNow);
+    ++mResult.messages;
+    if (mRecentMessages.size() > MESSAGE_LIMIT)
+    {
+        ++mResult.messageLimitBreaches;
+        mTrader.Trader().ErrorMessageHandler(message.clientOrderId, "message limit exceeded");
+        return;
+    }
+
+    switch (message.type)
+    {
+    case SentMessage::Type::INSERT:
+    {
+        if (message.clientOrderId <= mLastOrderId || message.volume == 0)
+        {
+            mTrader.Trader().ErrorMessageHandler(message.clientOrderId, "invalid order");
+            return;
+        }
+        mLastOrderId = message.clientOrderId;
+        if (WorstCasePosition(message.side) + static_cast<signed long>(message.volume) > POSITION_LIMIT)
+        {
+            // The exchange rejects an order that could take the position
+            // past the limit if it and every other order on its side filled.
+            ++mResult.positionLimitBreaches;
+            mTrader.Trader().ErrorMessageHandler(message.clientOrderId, "order rejected: position limit");
+            return;
+        }
+        RestingOrder order{message.side, message.price, message.volume};
+        // An order that crosses takes the top level and rests any remainder.
+        const bool buy = message.side == Side::BUY;
+        const unsigned long touch = buy ? mETF.askPrices[0] : mETF.bidPrices[0];
+        if (buy ? message.price >= touch : message.price <= touch)
+        {
+            unsigned long& available = buy ? mETF.askVolumes[0] : mETF.bidVolumes[0];
+            const unsigned long volume = std::min(order.remaining, available);
+            available -= volume;
+            Fill(message.clientOrderId, order, touch, volume, ETF_TAKER_FEE);
+        }
+        if (order.remaining != 0)
+        {
+            mOrders.emplace(message.clientOrderId, order);
+        }
+        break;
+    }
+    case SentMessage::Type::CANCEL:
+    {
+        auto it = mOrders.find(message.clientOrderId);
+        if (it != mOrders.end())
+        {
+            mTrader.Trader().OrderStatusMessageHandler(message.clientOrderId, it->second.filled, 0, it->second.fees);
+            mOrders.erase(it);
+        }
+        break;
+    }
+    case SentMessage::Type::AMEND:
+        // The AutoTrader never amends, so amends are not simulated.
+        mTrader.Trader().ErrorMessageHandler(message.clientOrderId, "amends are not simulated");
+        break;
+    case SentMessage::Type::HEDGE:
+    {
+        // Hedges trade against the future book at its touch if their price
+        // allows, and are rejected outright if they would take the future
+        // position past its limit.
+        const bool buy = message.side == Side::BUY;
+        const unsigned long touch = buy ? mFuture.askPrices[0] : mFuture.bidPrices[0];
+        const auto volume = static_cast<signed long>(message.volume);
+        if (std::abs(mFuturePosition + (buy ? volume : -volume)) > POSITION_LIMIT)
+        {
+            ++mResult.positionLimitBreaches;
+            ++mResult.failedHedges;
+            mTrader.Trader().HedgeFilledMessageHandler(message.clientOrderId, 0, 0);
+        }
+        else if (buy ? message.price >= touch : message.price <= touch)
+        {
+            mFuturePosition += buy ? volume : -volume;
+            mCash += (buy ? -1 : 1) * static_cast<signed long>(touch) * volume;
+            mTrader.Trader().HedgeFilledMessageHandler(message.clientOrderId, touch, message.volume);
+        }
+        else
+        {
+            ++mResult.failedHedges;
+            mTrader.Trader().HedgeFilledMessageHandler(message.clientOrderId, 0, 0);
+        }
+        break;
+    }
+    }
+}
+
+void SimulatedExchange::FillRestingOrders()
+{
+    // A resting order trades at its own price when the market moves through
+    // it, and otherwise with other participants' flow while at or inside
+    // the touch.
+    const double flowProbability = mConfig.fillRate * mConfig.stepSeconds;
+    for (auto it = mOrders.begin(); it != mOrders.end();)
+    {
+        RestingOrder& order = it->second;
+        const bool buy = order.side == Side::BUY;
+        const bool through = buy ? order.price >= mETF.askPrices[0] : order.price <= mETF.bidPrices[0];
+        const bool atTouch = buy ? order.price >= mETF.bidPrices[0] : order.price <= mETF.askPrices[0];
+        unsigned long volume = 0;
+        if (through)
+        {
+            volume = order.remaining;
+        }
+        else if (atTouch && mUniform(mRandom) < flowProbability)
+        {
+            volume = std::uniform_int_distribution<unsigned long>(1, order.remaining)(mRandom);
+        }
+        if (volume != 0)
+        {
+            Fill(it->first, order, order.price, volume, ETF_MAKER_FEE);
+        }
+        it = (order.remaining == 0) ? mOrders.erase(it) : std::next(it);
+    }
+}
+
+void SimulatedExchange::Collect()
+{
+    for (const SentMessage& message : mTrader.Sent())
+    {
+        mInFlight.emplace_back(mNow + mConfig.latencySeconds, message);
+    }
+    mTrader.Sent().clear();
+}
+
+void SimulatedExchange::CheckRules()
+{
+    mResult.maxPosition = std::max(mResult.maxPosition, std::abs(mETFPosition));
+
+    const signed long unhedged = std::abs(mETFPosition + mFuturePosition);
+    mResult.maxUnhedged = std::max(mResult.maxUnhedged, unhedged);
+    if (unhedged <= UNHEDGED_LOTS_LIMIT)
+    {
+        mUnhedgedSince = -1.0;
+        mHedgeBreached = false;
+    }
+    else if (mUnhedgedSince < 0.0)
+    {
+        mUnhedgedSince = mNow;
+    }
+    else if (!mHedgeBreached && mNow - mUnhedgedSince > HEDGE_DEADLINE_SECONDS)
+    {
+        ++mResult.hedgeDeadlineBreaches;
+        mHedgeBreached = true;
+    }
+}
+
+SessionResult SimulatedExchange::Run()
+{
+    const auto bookEvery = std::max(1L, std::lround(mConfig.bookIntervalSeconds / mConfig.stepSeconds));
+    const auto steps = std::lround(mConfig.durationSeconds / mConfig.stepSeconds);
+    for (long step = 0; step < steps; ++step)
+    {
+        mNow = static_cast<double>(step) * mConfig.stepSeconds;
+        mTrader.SetTime(Time());
+        MoveMarket();
+        FillRestingOrders();
+        while (!mInFlight.empty() && mInFlight.front().first <= mNow)
+        {
+            const SentMessage message = mInFlight.front().second;
+            mInFlight.pop_front();
+            Deliver(message);
+        }
+        if (step % bookEvery == 0)
+        {
+            ++mSequenceNumber;
+            mTrader.Trader().OrderBookMessageHandler(Instrument::FUTURE, mSequenceNumber, mFuture.askPrices,
+                                                     mFuture.askVolumes, mFuture.bidPrices, mFuture.bidVolumes);
+            mTrader.Trader().OrderBookMessageHandler(Instrument::ETF, mSequenceNumber, mETF.askPrices,
+                                                     mETF.askVolumes, mETF.bidPrices, mETF.bidVolumes);
+        }
+        Collect();
+        CheckRules();
+    }
+
+    const double etfMid = static_cast<double>(mETF.askPrices[0] + mETF.bidPrices[0]) / 2.0;
+    const double futureMid = static_cast<double>(mFuture.askPrices[0] + mFuture.bidPrices[0]) / 2.0;
+    mResult.profitLoss = mCash + std::lround(static_cast<double>(mETFPosition) * etfMid
+                                             + static_cast<double>(mFuturePosition) * futureMid);
+    return mResult;
+}
+
+}
+
+SessionResult RunSession(const SessionConfig& config)
+{
+    DrivenTrader trader(config.parameters);
+    SimulatedExchange exchange(config, trader);
+    return exchange.Run();
+}
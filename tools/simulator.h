@@ -0,0 +1,56 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TOOLS_SIMULATOR_H
+#define CPPREADY_TRADER_GO_TOOLS_SIMULATOR_H
+
+#include "quotekernel.h"
+
+// How a synthetic session's market and exchange behave.
+struct SessionConfig
+{
+    unsigned long seed = 1;
+    double durationSeconds = 900.0;
+    double stepSeconds = 0.05;
+    double bookIntervalSeconds = 0.25;
+    double volatility = 0.0005;    // of the future mid, per square root second
+    double basisNoise = 100.0;     // stationary standard deviation of the ETF/future basis in cents
+    double basisReversion = 0.5;   // per second
+    double latencySeconds = 0.001; // from the trader to the exchange
+    double fillRate = 0.2;         // per second, for a resting order at or inside the touch
+    QuoteParameters parameters;
+};
+
+struct SessionResult
+{
+    signed long profitLoss = 0; // in cents, net of fees, marked to the final mids
+    signed long maxPosition = 0;
+    signed long maxUnhedged = 0;
+    unsigned long etfVolume = 0;
+    unsigned long messages = 0;
+    unsigned long messageLimitBreaches = 0;
+    unsigned long positionLimitBreaches = 0; // inserts and hedges rejected for risking a position limit
+    unsigned long hedgeDeadlineBreaches = 0;
+    unsigned long failedHedges = 0;
+};
+
+// Run one synthetic session of the AutoTrader, as a DrivenTrader, against
+// a simulated exchange. The result depends only on the config, seed
+// included, and on the signal model in the working directory.
+SessionResult RunSession(const SessionConfig& config);
+
+#endif //CPPREADY_TRADER_GO_TOOLS_SIMULATOR_H
@@ -0,0 +1,229 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "quotekernel.h"
+
+using namespace ReadyTraderGo;
+
+// Replays the market data in a journal against many quote parameter sets at
+// once.
+//
+// Every parameter set is a lane of a QuoteLanes structure, so each order
+// book event costs one vectorised DecideQuoteLanes pass plus per-lane order
+// and fill bookkeeping, instead of one full replay per parameter set. Each
+// lane keeps its own simulated orders: a buy (sell) order fills against the
+// ETF best ask (bid) volume while it is at or through that price, and each
+// fill is hedged immediately at the future best price. Lanes do not see
+// each other's market impact, and signal skew and fees are not modelled.
+
+constexpr double TICK_SIZE_IN_CENTS = 100.0;
+
+struct SweepLanes
+{
+    explicit SweepLanes(std::size_t count)
+        : quotes(count), askRemaining(quotes.size), bidRemaining(quotes.size), futurePosition(quotes.size),
+          cash(quotes.size), tradedVolume(quotes.size), messages(quotes.size)
+    {
+    }
+
+    QuoteLanes quotes;
+    std::vector<signed long> askRemaining;
+    std::vector<signed long> bidRemaining;
+    std::vector<signed long> futurePosition;
+    std::vector<signed long> cash;
+    std::vector<signed long> tradedVolume;
+    std::vector<signed long> messages;
+};
+
+struct Market
+{
+    unsigned long etfAskPrice = 0;
+    unsigned long etfBidPrice = 0;
+    unsigned long etfAskVolume = 0;
+    unsigned long etfBidVolume = 0;
+    unsigned long futAskPrice = 0;
+    unsigned long futBidPrice = 0;
+};
+
+static std::vector<signed long> ParseList(const std::string& text)
+{
+    std::vector<signed long> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        values.push_back(std::atol(item.c_str()));
+    }
+    return values;
+}
+
+// Apply each lane's decision, then fill its resting orders against the book.
+static void Step(SweepLanes& lanes, const Market& market)
+{
+    QuoteLanes& quotes = lanes.quotes;
+    const auto etfAsk = static_cast<signed long>(market.etfAskPrice);
+    const auto etfBid = static_cast<signed long>(market.etfBidPrice);
+    const auto futAsk = static_cast<signed long>(market.futAskPrice);
+    const auto futBid = static_cast<signed long>(market.futBidPrice);
+    const auto etfAskVolume = static_cast<signed long>(market.etfAskVolume);
+    const auto etfBidVolume = static_cast<signed long>(market.etfBidVolume);
+
+    for (std::size_t k = 0; k < quotes.size; ++k)
+    {
+        // A cancelled order is gone; an insert replaces it.
+        lanes.askRemaining[k] = quotes.cancelAsk[k] ? 0 : lanes.askRemaining[k];
+        lanes.bidRemaining[k] = quotes.cancelBid[k] ? 0 : lanes.bidRemaining[k];
+        lanes.askRemaining[k] = quotes.insertAsk[k] ? quotes.askVolume[k] : lanes.askRemaining[k];
+        lanes.bidRemaining[k] = quotes.insertBid[k] ? quotes.bidVolume[k] : lanes.bidRemaining[k];
+        quotes.askPrice[k] = quotes.insertAsk[k] ? quotes.newAskPrice[k] : quotes.askPrice[k];
+        quotes.bidPrice[k] = quotes.insertBid[k] ? quotes.newBidPrice[k] : quotes.bidPrice[k];
+        lanes.messages[k] += quotes.cancelAsk[k] + quotes.cancelBid[k] + quotes.insertAsk[k] + quotes.insertBid[k];
+
+        const signed long bought = (etfAsk != 0 && static_cast<signed long>(quotes.askPrice[k]) >= etfAsk)
+                                   ? std::min(lanes.askRemaining[k], etfAskVolume) : 0;
+        const signed long sold = (etfBid != 0 && static_cast<signed long>(quotes.bidPrice[k]) <= etfBid)
+                                 ? std::min(lanes.bidRemaining[k], etfBidVolume) : 0;
+        lanes.askRemaining[k] -= bought;
+        lanes.bidRemaining[k] -= sold;
+        quotes.position[k] += bought - sold;
+        lanes.futurePosition[k] += sold - bought;
+        lanes.cash[k] += sold * etfBid - bought * etfAsk + bought * futBid - sold * futAsk;
+        lanes.tradedVolume[k] += bought + sold;
+        lanes.messages[k] += (bought != 0) + (sold != 0);
+
+        // Fully filled orders are finished, as on an OrderStatus with no
+        // remaining volume.
+        quotes.askLive[k] = lanes.askRemaining[k] != 0 ? 1 : 0;
+        quotes.bidLive[k] = lanes.bidRemaining[k] != 0 ? 1 : 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 5)
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " <journal> <min edges in ticks> <position limits> <lot sizes>" << std::endl
+                  << "each list is comma separated; every combination is evaluated" << std::endl;
+        return 1;
+    }
+
+    std::vector<JournalRecord> records;
+    std::string error;
+    if (!ReadJournal(argv[1], records, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const std::vector<signed long> edges = ParseList(argv[2]);
+    const std::vector<signed long> limits = ParseList(argv[3]);
+    const std::vector<signed long> lotSizes = ParseList(argv[4]);
+    const std::size_t count = edges.size() * limits.size() * lotSizes.size();
+    if (count == 0)
+    {
+        std::cerr << "empty parameter list" << std::endl;
+        return 1;
+    }
+
+    SweepLanes lanes(count);
+    std::size_t k = 0;
+    for (signed long edge : edges)
+    {
+        for (signed long limit : limits)
+        {
+            for (signed long lotSize : lotSizes)
+            {
+                lanes.quotes.minEdge[k] = edge * static_cast<signed long>(TICK_SIZE_IN_CENTS);
+                lanes.quotes.positionLimit[k] = limit;
+                lanes.quotes.lotSize[k] = lotSize;
+                ++k;
+            }
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Market market;
+    unsigned long events = 0;
+    for (const JournalRecord& record : records)
+    {
+        if (record.type != JournalRecordType::ORDER_BOOK)
+        {
+            continue;
+        }
+
+        QuoteInputs inputs;
+        if (record.instrument == Instrument::ETF)
+        {
+            market.etfAskPrice = record.askPrices[0];
+            market.etfBidPrice = record.bidPrices[0];
+            market.etfAskVolume = record.askVolumes[0];
+            market.etfBidVolume = record.bidVolumes[0];
+        }
+        else
+        {
+            market.futAskPrice = record.askPrices[0];
+            market.futBidPrice = record.bidPrices[0];
+        }
+        inputs.etfAskPrice = market.etfAskPrice;
+        inputs.etfBidPrice = market.etfBidPrice;
+        inputs.futAskPrice = market.futAskPrice;
+        inputs.futBidPrice = market.futBidPrice;
+        inputs.futAskVolume = record.askVolumes[0];
+        inputs.futBidVolume = record.bidVolumes[0];
+        inputs.etfUpdate = record.instrument == Instrument::ETF;
+
+        DecideQuoteLanes(lanes.quotes, inputs);
+        Step(lanes, market);
+        ++events;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const signed long etfMid = static_cast<signed long>(market.etfAskPrice + market.etfBidPrice) / 2;
+    const signed long futMid = static_cast<signed long>(market.futAskPrice + market.futBidPrice) / 2;
+    std::vector<signed long> pnl(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        pnl[i] = lanes.cash[i] + lanes.quotes.position[i] * etfMid + lanes.futurePosition[i] * futMid;
+    }
+
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return pnl[a] > pnl[b]; });
+
+    std::cout << "min_edge_ticks,position_limit,lot_size,pnl,traded_volume,messages,final_position\n";
+    for (std::size_t i : order)
+    {
+        std::cout << lanes.quotes.minEdge[i] / static_cast<signed long>(TICK_SIZE_IN_CENTS) << ','
+                  << lanes.quotes.positionLimit[i] << ',' << lanes.quotes.lotSize[i] << ',' << pnl[i] << ','
+                  << lanes.tradedVolume[i] << ',' << lanes.messages[i] << ',' << lanes.quotes.position[i] << '\n';
+    }
+    std::cerr << count << " parameter sets over " << events << " book events in " << seconds << "s ("
+              << static_cast<double>(count) * static_cast<double>(events) / seconds << " lane-events/s)"
+              << std::endl;
+    return 0;
+}
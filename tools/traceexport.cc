@@ -0,0 +1,229 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "journal.h"
+#include "tracing.h"
+
+using namespace ReadyTraderGo;
+
+// Converts AutoTrader trace files, and journals, to Chrome trace event JSON
+// for chrome://tracing or the Perfetto UI, which imports the same format.
+//
+// Each input file becomes one process. Trace spans become complete events
+// on the thread that recorded them, so a handler's Send* calls nest inside
+// it, except for hedges, which outlive the handler that sent them and are
+// drawn as async spans. Journals have no durations: each record becomes an
+// instant on an inbound, send or annotation track, and each hedge order an
+// async span up to its fill, which is enough to see bursts and cancel and
+// insert storms in a replayed or recorded session.
+
+constexpr int JOURNAL_INBOUND_TRACK = 1;
+constexpr int JOURNAL_SEND_TRACK = 2;
+constexpr int JOURNAL_ANNOTATION_TRACK = 3;
+
+static const char* JournalTypeName(JournalRecordType type)
+{
+    static const char* const NAMES[] = {"order_book", "trade_ticks", "order_filled", "order_status",
+                                        "hedge_filled", "error", "disconnect", "insert_order", "cancel_order",
+                                        "hedge_order", "opportunity", "round_trip"};
+    const auto index = static_cast<std::size_t>(type);
+    return index < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[index] : "unknown";
+}
+
+static const char* InstrumentName(Instrument instrument)
+{
+    return instrument == Instrument::ETF ? "etf" : "future";
+}
+
+// Chrome trace timestamps are in microseconds.
+static void Timestamp(std::FILE* out, const char* key, signed long nanoseconds)
+{
+    std::fprintf(out, ",\"%s\":%ld.%03ld", key, nanoseconds / 1000, nanoseconds % 1000);
+}
+
+class EventWriter
+{
+public:
+    explicit EventWriter(std::FILE* out) : mOut(out)
+    {
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", mOut);
+    }
+
+    ~EventWriter()
+    {
+        std::fputs("\n]}\n", mOut);
+    }
+
+    // Start an event; the caller adds fields with Timestamp and fprintf,
+    // then calls End.
+    std::FILE* Begin(const char* name, const char* category, char phase, int pid, int tid)
+    {
+        std::fprintf(mOut, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d",
+                     mFirst ? "" : ",", name, category, phase, pid, tid);
+        mFirst = false;
+        return mOut;
+    }
+
+    void End()
+    {
+        std::fputc('}', mOut);
+    }
+
+    void Name(const char* metadata, int pid, int tid, const std::string& name)
+    {
+        Begin(metadata, "__metadata", 'M', pid, tid);
+        std::fprintf(mOut, ",\"args\":{\"name\":\"%s\"}", name.c_str());
+        End();
+    }
+
+private:
+    std::FILE* mOut;
+    bool mFirst = true;
+};
+
+static void WriteSpans(EventWriter& writer, int pid, const std::vector<TraceSpan>& spans)
+{
+    unsigned short threads = 0;
+    for (const TraceSpan& span : spans)
+    {
+        const char* name = TraceNameString(span.name);
+        if (span.name == TraceName::HEDGE)
+        {
+            std::FILE* out = writer.Begin(name, "hedge", 'b', pid, span.thread);
+            Timestamp(out, "ts", span.begin);
+            std::fprintf(out, ",\"id\":%lu,\"args\":{\"order\":%lu}", span.orderId, span.orderId);
+            writer.End();
+            out = writer.Begin(name, "hedge", 'e', pid, span.thread);
+            Timestamp(out, "ts", span.end);
+            std::fprintf(out, ",\"id\":%lu", span.orderId);
+            writer.End();
+        }
+        else
+        {
+            const bool send = span.name == TraceName::INSERT_ORDER || span.name == TraceName::CANCEL_ORDER
+                              || span.name == TraceName::HEDGE_ORDER;
+            std::FILE* out = writer.Begin(name, send ? "send" : "handler", 'X', pid, span.thread);
+            Timestamp(out, "ts", span.begin);
+            Timestamp(out, "dur", span.end - span.begin);
+            std::fprintf(out, ",\"args\":{\"instrument\":\"%s\",\"order\":%lu}", InstrumentName(span.instrument),
+                         span.orderId);
+            writer.End();
+        }
+        threads = std::max(threads, span.thread);
+    }
+    for (unsigned short thread = 1; thread <= threads; ++thread)
+    {
+        writer.Name("thread_name", pid, thread, "thread " + std::to_string(thread));
+    }
+}
+
+static void WriteJournal(EventWriter& writer, int pid, const std::vector<JournalRecord>& records)
+{
+    for (const JournalRecord& record : records)
+    {
+        const char* name = JournalTypeName(record.type);
+        const int track = (record.type < JournalRecordType::INSERT_ORDER) ? JOURNAL_INBOUND_TRACK
+                          : (record.type <= JournalRecordType::HEDGE_ORDER) ? JOURNAL_SEND_TRACK
+                          : JOURNAL_ANNOTATION_TRACK;
+        std::FILE* out = writer.Begin(name, "journal", 'i', pid, track);
+        Timestamp(out, "ts", record.timestamp);
+        std::fprintf(out, ",\"s\":\"t\",\"args\":{\"instrument\":\"%s\",\"order\":%lu,\"price\":%lu,\"volume\":%lu}",
+                     InstrumentName(record.instrument), record.clientOrderId, record.price, record.volume);
+        writer.End();
+
+        if (record.type == JournalRecordType::HEDGE_ORDER || record.type == JournalRecordType::HEDGE_FILLED)
+        {
+            const char phase = (record.type == JournalRecordType::HEDGE_ORDER) ? 'b' : 'e';
+            out = writer.Begin("hedge", "hedge", phase, pid, JOURNAL_SEND_TRACK);
+            Timestamp(out, "ts", record.timestamp);
+            std::fprintf(out, ",\"id\":%lu", record.clientOrderId);
+            writer.End();
+        }
+    }
+    writer.Name("thread_name", pid, JOURNAL_INBOUND_TRACK, "inbound");
+    writer.Name("thread_name", pid, JOURNAL_SEND_TRACK, "sends");
+    writer.Name("thread_name", pid, JOURNAL_ANNOTATION_TRACK, "annotations");
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace or journal file or directory>... > trace.json" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> filenames;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::filesystem::is_directory(argv[i]))
+        {
+            filenames.emplace_back(argv[i]);
+            continue;
+        }
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(argv[i], ec))
+        {
+            const std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == TRACE_EXTENSION || extension == JOURNAL_EXTENSION))
+            {
+                filenames.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(filenames.begin(), filenames.end());
+
+    EventWriter writer(stdout);
+    int pid = 0;
+    for (const std::string& filename : filenames)
+    {
+        std::string error;
+        bool read = false;
+        if (std::filesystem::path(filename).extension() == TRACE_EXTENSION)
+        {
+            std::vector<TraceSpan> spans;
+            if ((read = ReadTrace(filename, spans, error)))
+            {
+                WriteSpans(writer, ++pid, spans);
+            }
+        }
+        else
+        {
+            std::vector<JournalRecord> records;
+            if ((read = ReadJournal(filename, records, error)))
+            {
+                WriteJournal(writer, ++pid, records);
+            }
+        }
+        if (read)
+        {
+            writer.Name("process_name", pid, 0, std::filesystem::path(filename).filename().string());
+        }
+        else
+        {
+            std::cerr << "skipping " << error << std::endl;
+        }
+    }
+    return 0;
+}
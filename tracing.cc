@@ -0,0 +1,202 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "backgroundthread.h"
+#include "sessionfile.h"
+#include "tracing.h"
+
+constexpr std::size_t TRACE_FILE_BUFFER_SIZE = 1 << 18;
+constexpr std::chrono::milliseconds TRACE_IDLE_SLEEP{1};
+
+// Distinguishes tracers so that a thread's cached buffer is never taken for
+// one belonging to a later tracer at the same address.
+static std::atomic<unsigned long> sNextTracerId{1};
+
+const char* TraceNameString(TraceName name) noexcept
+{
+    switch (name)
+    {
+    case TraceName::ORDER_BOOK:
+        return "order_book";
+    case TraceName::TRADE_TICKS:
+        return "trade_ticks";
+    case TraceName::ORDER_FILLED:
+        return "order_filled";
+    case TraceName::ORDER_STATUS:
+        return "order_status";
+    case TraceName::HEDGE_FILLED:
+        return "hedge_filled";
+    case TraceName::ERROR:
+        return "error";
+    case TraceName::INSERT_ORDER:
+        return "insert_order";
+    case TraceName::CANCEL_ORDER:
+        return "cancel_order";
+    case TraceName::HEDGE_ORDER:
+        return "hedge_order";
+    case TraceName::HEDGE:
+        return "hedge";
+    }
+    return "unknown";
+}
+
+bool ReadTrace(const std::string& filename, std::vector<TraceSpan>& spans, std::string& error)
+{
+    spans.clear();
+
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    TraceHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != TRACE_MAGIC)
+    {
+        std::fclose(file);
+        error = filename + " is not a trace";
+        return false;
+    }
+    if (header.version != TRACE_VERSION || header.recordSize != sizeof(TraceSpan))
+    {
+        std::fclose(file);
+        error = filename + " has trace version " + std::to_string(header.version) + ", expected "
+                + std::to_string(TRACE_VERSION);
+        return false;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filename, ec);
+    if (!ec && size > sizeof(header))
+    {
+        spans.resize((size - sizeof(header)) / sizeof(TraceSpan));
+    }
+    const std::size_t count = std::fread(spans.data(), sizeof(TraceSpan), spans.size(), file);
+    spans.resize(count);
+    std::fclose(file);
+    return true;
+}
+
+Tracer::Tracer(std::FILE* file) : mId(sNextTracerId.fetch_add(1)), mFile(file), mThread(&Tracer::Run, this)
+{
+}
+
+Tracer::~Tracer()
+{
+    mRunning.store(false, std::memory_order_release);
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    std::fclose(mFile);
+}
+
+std::unique_ptr<Tracer> Tracer::Create(const std::string& directory,
+                                       const std::string& session,
+                                       std::string& error)
+{
+    std::string filename;
+    std::FILE* file = CreateSessionFile(directory, session, TRACE_EXTENSION, filename, error);
+    if (file == nullptr)
+    {
+        return nullptr;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+
+    TraceHeader header;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        std::fclose(file);
+        error = "cannot write to " + filename;
+        return nullptr;
+    }
+    return std::make_unique<Tracer>(file);
+}
+
+void Tracer::Record(const TraceSpan& span) noexcept
+{
+    if (!LocalBuffer().ring.TryPush(span))
+    {
+        mDroppedSpans.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Tracer::ThreadBuffer& Tracer::LocalBuffer()
+{
+    thread_local unsigned long owner = 0;
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (owner != mId)
+    {
+        std::lock_guard<std::mutex> lock(mBuffersMutex);
+        mBuffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = mBuffers.back().get();
+        buffer->thread = static_cast<unsigned short>(mBuffers.size());
+        owner = mId;
+    }
+    return *buffer;
+}
+
+void Tracer::Run()
+{
+    LowerThreadPriority();
+    std::vector<ThreadBuffer*> buffers;
+    TraceSpan span;
+    for (;;)
+    {
+        // Read the flag first so that nothing recorded before it was
+        // cleared can be left behind by the final pass.
+        const bool running = mRunning.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(mBuffersMutex);
+            buffers.clear();
+            for (const auto& buffer : mBuffers)
+            {
+                buffers.push_back(buffer.get());
+            }
+        }
+
+        bool written = false;
+        for (ThreadBuffer* buffer : buffers)
+        {
+            while (buffer->ring.TryPop(span))
+            {
+                span.thread = buffer->thread;
+                std::fwrite(&span, sizeof(span), 1, mFile);
+                written = true;
+            }
+        }
+
+        if (!running)
+        {
+            break;
+        }
+
+        if (written)
+        {
+            std::fflush(mFile);
+        }
+        else
+        {
+            std::this_thread::sleep_for(TRACE_IDLE_SLEEP);
+        }
+    }
+}
@@ -0,0 +1,178 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_TRACING_H
+#define CPPREADY_TRADER_GO_TRACING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <ready_trader_go/types.h>
+
+#include "spscring.h"
+
+constexpr unsigned int TRACE_MAGIC = 0x54475452; // "RTGT"
+constexpr unsigned int TRACE_VERSION = 1;
+constexpr std::size_t TRACE_RING_CAPACITY = 16384;
+constexpr char TRACE_EXTENSION[] = ".rtgt";
+
+// What a span covers. Codes are written to trace files, so only ever
+// append.
+enum class TraceName : unsigned char
+{
+    // AutoTrader handlers.
+    ORDER_BOOK,
+    TRADE_TICKS,
+    ORDER_FILLED,
+    ORDER_STATUS,
+    HEDGE_FILLED,
+    ERROR,
+
+    // Send* calls.
+    INSERT_ORDER,
+    CANCEL_ORDER,
+    HEDGE_ORDER,
+
+    // A hedge order, from its send to its outcome.
+    HEDGE
+};
+
+constexpr std::size_t TRACE_NAME_COUNT = 10;
+
+const char* TraceNameString(TraceName name) noexcept;
+
+// One closed span. Times are steady clock nanoseconds; the thread is a small
+// number assigned to each thread that records spans, filled in when the span
+// is written out.
+struct TraceSpan
+{
+    signed long begin = 0;
+    signed long end = 0;
+    unsigned long orderId = 0; // zero if the span is not about one order
+    TraceName name = TraceName::ORDER_BOOK;
+    ReadyTraderGo::Instrument instrument = ReadyTraderGo::Instrument::ETF;
+    unsigned short thread = 0;
+    unsigned int reserved = 0;
+};
+
+static_assert(sizeof(TraceSpan) == 32, "trace spans are fixed width");
+static_assert(std::is_trivially_copyable<TraceSpan>::value, "trace spans are written as raw bytes");
+
+struct TraceHeader
+{
+    unsigned int magic = TRACE_MAGIC;
+    unsigned int version = TRACE_VERSION;
+    unsigned int recordSize = sizeof(TraceSpan);
+    unsigned int reserved = 0;
+};
+
+// Read a whole trace file into memory. Returns false and describes the
+// problem in error if the file is missing or malformed.
+bool ReadTrace(const std::string& filename, std::vector<TraceSpan>& spans, std::string& error);
+
+// Records spans to a trace file.
+//
+// Each recording thread gets its own lock-free ring the first time it
+// records, so any thread may record without contention; a low-priority
+// background thread drains every ring to the file. Spans are dropped and
+// counted if a ring is full.
+class Tracer
+{
+public:
+    explicit Tracer(std::FILE* file);
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // Create a tracer writing to a new trace file named for the session, see
+    // NewSessionName, in the given directory. Returns null if the directory
+    // does not exist or the file already does.
+    static std::unique_ptr<Tracer> Create(const std::string& directory,
+                                          const std::string& session,
+                                          std::string& error);
+
+    static signed long Now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Record(const TraceSpan& span) noexcept;
+
+    unsigned long DroppedSpans() const { return mDroppedSpans.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadBuffer
+    {
+        unsigned short thread;
+        SPSCRing<TraceSpan, TRACE_RING_CAPACITY> ring;
+    };
+
+    ThreadBuffer& LocalBuffer();
+    void Run();
+
+    unsigned long mId;
+    std::FILE* mFile;
+    std::mutex mBuffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+    std::atomic<bool> mRunning{true};
+    std::atomic<unsigned long> mDroppedSpans{0};
+    std::thread mThread;
+};
+
+// Records a span covering its own lifetime, if given a tracer.
+class TraceScope
+{
+public:
+    TraceScope(Tracer* tracer, TraceName name, ReadyTraderGo::Instrument instrument, unsigned long orderId) noexcept
+        : mTracer(tracer)
+    {
+        if (mTracer != nullptr)
+        {
+            mSpan.name = name;
+            mSpan.instrument = instrument;
+            mSpan.orderId = orderId;
+            mSpan.begin = Tracer::Now();
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    ~TraceScope()
+    {
+        if (mTracer != nullptr)
+        {
+            mSpan.end = Tracer::Now();
+            mTracer->Record(mSpan);
+        }
+    }
+
+private:
+    Tracer* mTracer;
+    TraceSpan mSpan;
+};
+
+#endif //CPPREADY_TRADER_GO_TRACING_H
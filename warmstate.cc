@@ -0,0 +1,139 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "warmstate.h"
+
+namespace
+{
+template<typename T>
+bool ReadValue(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template<typename T>
+bool WriteValue(std::ostream& stream, const T& value)
+{
+    return static_cast<bool>(stream.write(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+}
+
+bool WarmState::Load(const std::string& filename, std::string& error)
+{
+    mSections.clear();
+
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    unsigned int magic = 0;
+    unsigned int version = 0;
+    unsigned int count = 0;
+    unsigned int reserved = 0;
+    if (!ReadValue(stream, magic) || !ReadValue(stream, version) || !ReadValue(stream, count)
+        || !ReadValue(stream, reserved))
+    {
+        error = "truncated header in " + filename;
+        return false;
+    }
+    if (magic != WARM_STATE_MAGIC || version != WARM_STATE_VERSION)
+    {
+        error = filename + " is not a version " + std::to_string(WARM_STATE_VERSION) + " warm state";
+        return false;
+    }
+
+    // Section sizes are checked against what is left of the file before
+    // anything is allocated for them, so a corrupt size cannot exhaust
+    // memory.
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(filename, ec);
+    if (ec)
+    {
+        error = "cannot size " + filename + ": " + ec.message();
+        return false;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int tag = 0;
+        unsigned int size = 0;
+        std::vector<char> data;
+        if (ReadValue(stream, tag) && ReadValue(stream, size))
+        {
+            const auto position = static_cast<std::uintmax_t>(stream.tellg());
+            if (size > fileSize - position)
+            {
+                mSections.clear();
+                error = "section larger than the file in " + filename;
+                return false;
+            }
+            data.resize(size);
+        }
+        if (!stream || !stream.read(data.data(), size))
+        {
+            mSections.clear();
+            error = "truncated section in " + filename;
+            return false;
+        }
+        mSections[static_cast<WarmStateTag>(tag)] = std::move(data);
+    }
+    return true;
+}
+
+bool WarmState::Save(const std::string& filename, std::string& error) const
+{
+    const std::string temporary = filename + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            error = "cannot create " + temporary;
+            return false;
+        }
+
+        bool ok = WriteValue(stream, WARM_STATE_MAGIC) && WriteValue(stream, WARM_STATE_VERSION)
+                  && WriteValue(stream, static_cast<unsigned int>(mSections.size()))
+                  && WriteValue(stream, 0u);
+        for (const auto& [tag, data] : mSections)
+        {
+            ok = ok && WriteValue(stream, static_cast<unsigned int>(tag))
+                 && WriteValue(stream, static_cast<unsigned int>(data.size()))
+                 && stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        if (!ok || !stream.flush())
+        {
+            error = "cannot write to " + temporary;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, filename, ec);
+    if (ec)
+    {
+        error = "cannot replace " + filename + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 Optiver Asia Pacific Pty. Ltd.
+//
+// This file is part of Ready Trader Go.
+//
+//     Ready Trader Go is free software: you can redistribute it and/or
+//     modify it under the terms of the GNU Affero General Public License
+//     as published by the Free Software Foundation, either version 3 of
+//     the License, or (at your option) any later version.
+//
+//     Ready Trader Go is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU Affero General Public License for more details.
+//
+//     You should have received a copy of the GNU Affero General Public
+//     License along with Ready Trader Go.  If not, see
+//     <https://www.gnu.org/licenses/>.
+#ifndef CPPREADY_TRADER_GO_WARMSTATE_H
+#define CPPREADY_TRADER_GO_WARMSTATE_H
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+constexpr unsigned int WARM_STATE_MAGIC = 0x57475452; // "RTGW"
+constexpr unsigned int WARM_STATE_VERSION = 2;
+
+// Sections of the warm state file. New sections take new tags; a section
+// whose layout changes must take a new tag too, or it will be discarded on
+// load by its size check.
+//
+// Tag 1 held the signal features' decaying trade flow totals in version 1
+// files. Those describe the last seconds of the previous session, so they
+// skewed the next session's first quotes with stale flow and are no longer
+// carried. Do not reuse the tag.
+enum class WarmStateTag : unsigned int
+{
+    MARKET_STATS = 2 // MarketStats
+};
+
+// Estimator state carried from one session to the next so that slowly
+// converging estimators do not start cold.
+//
+// Each estimator stores a trivially copyable snapshot of itself under its
+// own tag. A section that is missing, or whose size no longer matches the
+// type it is read into, is ignored and that estimator starts cold, so a
+// stale or partly unusable file never prevents start up.
+//
+// Warm state files are native-endian binary:
+//   uint32 magic, uint32 version, uint32 section count, uint32 reserved
+//   then per section: uint32 tag, uint32 size, byte data[size]
+class WarmState
+{
+public:
+    // Replace the current sections with those in the given file. Returns
+    // false and describes the problem in error if the file cannot be used,
+    // in which case the state is left empty.
+    bool Load(const std::string& filename, std::string& error);
+
+    // Write all sections to the given file. The file is written beside the
+    // target and renamed over it so an interrupted save leaves the previous
+    // state intact.
+    bool Save(const std::string& filename, std::string& error) const;
+
+    template<typename T>
+    void Put(WarmStateTag tag, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::vector<char>& data = mSections[tag];
+        data.resize(sizeof(T));
+        std::memcpy(data.data(), &value, sizeof(T));
+    }
+
+    // Copy a section into value. Returns false, leaving value untouched, if
+    // the section is missing or has the wrong size.
+    template<typename T>
+    bool Get(WarmStateTag tag, T& value) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto it = mSections.find(tag);
+        if (it == mSections.end() || it->second.size() != sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value, it->second.data(), sizeof(T));
+        return true;
+    }
+
+    std::size_t Size() const noexcept
+    {
+        return mSections.size();
+    }
+
+private:
+    std::map<WarmStateTag, std::vector<char>> mSections;
+};
+
+#endif //CPPREADY_TRADER_GO_WARMSTATE_H